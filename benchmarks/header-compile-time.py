@@ -0,0 +1,37 @@
+import os, sys, pathlib, subprocess, time, statistics, argparse
+
+# Measures how long it takes to compile a translation unit that includes the public niceshade
+# header (benchmarks/public-headers.cpp). Only the front end is exercised (-fsyntax-only), since
+# header cost is what is being measured. Run from any folder:
+#   python3 benchmarks/header-compile-time.py [--compiler c++] [--runs 10] [-I extra/include/dir]
+
+def main(argv):
+  repo_root = pathlib.Path(__file__).resolve().parent.parent
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--compiler', default=os.environ.get('CXX', 'c++'))
+  parser.add_argument('--runs', type=int, default=10)
+  parser.add_argument('-I', dest='include_dirs', action='append', default=[])
+  args = parser.parse_args(argv[1:])
+
+  source = repo_root / 'benchmarks' / 'public-headers.cpp'
+  command = [args.compiler, '-std=c++17', '-I', str(repo_root / 'libniceshade' / 'include')]
+  for include_dir in args.include_dirs:
+    command += ['-I', include_dir]
+
+  preprocessed = subprocess.run(command + ['-E', str(source)], capture_output=True, text=True)
+  if preprocessed.returncode != 0:
+    sys.stderr.write(preprocessed.stderr)
+    sys.exit(1)
+
+  timings = []
+  for _ in range(args.runs):
+    start = time.perf_counter()
+    subprocess.run(command + ['-fsyntax-only', str(source)], check=True)
+    timings.append(time.perf_counter() - start)
+
+  print('preprocessed lines: %d' % preprocessed.stdout.count('\n'))
+  print('compile time: best %.3f s, median %.3f s over %d runs'
+        % (min(timings), statistics.median(timings), args.runs))
+
+if __name__ == '__main__':
+  main(sys.argv)
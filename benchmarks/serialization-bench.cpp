@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Measures how fast serialized techniques load, both in place and from a copy. The techniques of
+ * the input file are compiled for the SPIR-V, Metal and OpenGL targets, and repeated to build a
+ * larger set. The DXC library is looked up next to the executable, like niceshade does.
+ *
+ * Usage: serialization_bench [input file] [copies] [iterations]
+ */
+
+#include "libniceshade/niceshade.h"
+#include "libniceshade/serialization.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace niceshade;
+
+namespace {
+
+struct load_timing {
+  double best_seconds  = 1e9;
+  double total_seconds = 0.0;
+};
+
+// Loads the data repeatedly, and returns false if any load fails.
+bool time_loads(
+    const std::shared_ptr<const std::vector<std::byte>>& data,
+    bool                                                 in_place,
+    uint32_t                                             iterations,
+    load_timing&                                         timing) {
+  const const_span<std::byte> span {data->data(), data->size()};
+  for (uint32_t i = 0u; i < iterations; ++i) {
+    const auto start  = std::chrono::steady_clock::now();
+    auto       result = deserialize_techniques(span, in_place ? data : nullptr);
+    const auto end    = std::chrono::steady_clock::now();
+    if (result.is_error()) {
+      fprintf(stderr, "%s", result.error_message().c_str());
+      return false;
+    }
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    timing.best_seconds  = std::min(timing.best_seconds, seconds);
+    timing.total_seconds += seconds;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  const char*    input_file = argc > 1 ? argv[1] : "tests/source_hlsl/relative_luminance.hlsl";
+  const uint32_t copies     = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 1000u;
+  const uint32_t iterations = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 20u;
+
+  const std::string exe_path(argv[0]);
+  instance::options opts;
+  opts.dxc_lib_folder = exe_path.substr(0, exe_path.find_last_of("/\\"));
+  value_or_error<instance> maybe_inst = instance::create(opts);
+  if (maybe_inst.is_error()) {
+    fprintf(stderr, "%s", maybe_inst.error_message().c_str());
+    return 1;
+  }
+  const target_desc targets[] = {
+      {target_api::VULKAN, 1u, 0u, target_platform_class::DONTCARE},
+      {target_api::METAL, 2u, 0u, target_platform_class::DESKTOP},
+      {target_api::GL, 4u, 3u, target_platform_class::DESKTOP}};
+  auto maybe_results = maybe_inst.get().parse_techniques_and_compile_file(
+      input_file,
+      const_span<target_desc> {targets, sizeof(targets) / sizeof(targets[0])},
+      define_container {});
+  if (maybe_results.is_error()) {
+    fprintf(stderr, "%s", maybe_results.error_message().c_str());
+    return 1;
+  }
+
+  // Build a larger set by loading the compiled techniques back several times.
+  const std::vector<std::byte> single =
+      serialize_techniques(std::get<compiled_techniques>(maybe_results.get()));
+  compiled_techniques repeated;
+  for (uint32_t c = 0u; c < copies; ++c) {
+    auto loaded = deserialize_techniques(const_span<std::byte> {single.data(), single.size()});
+    if (loaded.is_error()) {
+      fprintf(stderr, "%s", loaded.error_message().c_str());
+      return 1;
+    }
+    for (compiled_technique& tech : loaded.get()) { repeated.push_back(std::move(tech)); }
+  }
+  const auto data = std::make_shared<const std::vector<std::byte>>(serialize_techniques(repeated));
+
+  load_timing in_place, copying;
+  if (!time_loads(data, true, iterations, in_place) ||
+      !time_loads(data, false, iterations, copying)) {
+    return 1;
+  }
+
+  const double megabytes = (double)data->size() / (1024.0 * 1024.0);
+  printf("%.1f MB, %zu techniques\n", megabytes, repeated.size());
+  for (const auto& [label, timing] :
+       {std::make_pair("in place", &in_place), std::make_pair("copying", &copying)}) {
+    printf(
+        "  %-8s: best %.3f ms (%.0f MB/s), mean %.3f ms over %u iterations\n",
+        label,
+        timing->best_seconds * 1000.0,
+        megabytes / timing->best_seconds,
+        timing->total_seconds * 1000.0 / iterations,
+        iterations);
+  }
+  return 0;
+}
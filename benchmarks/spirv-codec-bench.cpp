@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Measures the compression ratio and the decoding speed of the SPIR-V codec on a folder of .spv
+ * files, such as the golden outputs in tests/goldens.
+ *
+ * Usage: spirv_codec_bench [folder] [iterations]
+ */
+
+#include "cli-tool/file-utils.h"
+#include "spirv-codec/spirv-codec.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct module {
+  std::string           name;
+  std::vector<uint32_t> spirv;
+  std::vector<uint8_t>  encoded;
+};
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  const std::string folder     = argc > 1 ? argv[1] : "tests/goldens";
+  const uint32_t    iterations = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 1000u;
+
+  std::vector<module> modules;
+  for (const auto& entry : std::filesystem::directory_iterator(folder)) {
+    if (entry.path().extension() != ".spv") { continue; }
+    const std::string contents = read_file(entry.path().string().c_str());
+    module            m;
+    m.name = entry.path().filename().string();
+    m.spirv.resize(contents.size() / sizeof(uint32_t));
+    memcpy(m.spirv.data(), contents.data(), m.spirv.size() * sizeof(uint32_t));
+    modules.push_back(std::move(m));
+  }
+  if (modules.empty()) {
+    fprintf(stderr, "no .spv files found in %s\n", folder.c_str());
+    return 1;
+  }
+  std::sort(modules.begin(), modules.end(), [](const module& a, const module& b) {
+    return a.name < b.name;
+  });
+
+  // Encode every module and make sure that it decodes back to the original.
+  size_t spirv_bytes = 0u, encoded_bytes = 0u;
+  for (module& m : modules) {
+    const size_t spirv_size   = m.spirv.size() * sizeof(uint32_t);
+    size_t       encoded_size = ngf_spvz_encode_bound(spirv_size);
+    m.encoded.resize(encoded_size);
+    ngf_spvz_error err =
+        ngf_spvz_encode(m.spirv.data(), spirv_size, m.encoded.data(), &encoded_size);
+    if (err != NGF_SPVZ_ERROR_OK) {
+      fprintf(stderr, "%s: failed to encode: %s\n", m.name.c_str(), ngf_spvz_get_error_name(err));
+      return 1;
+    }
+    m.encoded.resize(encoded_size);
+    std::vector<uint32_t> decoded(m.spirv.size());
+    err = ngf_spvz_decode(m.encoded.data(), encoded_size, decoded.data(), spirv_size);
+    if (err != NGF_SPVZ_ERROR_OK || decoded != m.spirv) {
+      fprintf(stderr, "%s: round trip failed: %s\n", m.name.c_str(), ngf_spvz_get_error_name(err));
+      return 1;
+    }
+    printf(
+        "%-56s %6zu -> %6zu bytes (%.2fx)\n",
+        m.name.c_str(),
+        spirv_size,
+        encoded_size,
+        (double)spirv_size / (double)encoded_size);
+    spirv_bytes += spirv_size;
+    encoded_bytes += encoded_size;
+  }
+
+  // Decode all modules repeatedly into a buffer large enough for any of them.
+  size_t max_words = 0u;
+  for (const module& m : modules) { max_words = std::max(max_words, m.spirv.size()); }
+  std::vector<uint32_t> decoded(max_words);
+  double                best_seconds = 1e9, total_seconds = 0.0;
+  for (uint32_t i = 0u; i < iterations; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const module& m : modules) {
+      size_t decoded_size = 0u;
+      ngf_spvz_get_decoded_size(m.encoded.data(), m.encoded.size(), &decoded_size);
+      ngf_spvz_decode(m.encoded.data(), m.encoded.size(), decoded.data(), decoded_size);
+    }
+    const auto   end     = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    best_seconds         = std::min(best_seconds, seconds);
+    total_seconds += seconds;
+  }
+
+  const double megabytes = (double)spirv_bytes / (1024.0 * 1024.0);
+  printf(
+      "%zu modules: %zu -> %zu bytes (%.2fx); decoding: best %.3f ms (%.0f MB/s), mean %.3f ms "
+      "over %u iterations\n",
+      modules.size(),
+      spirv_bytes,
+      encoded_bytes,
+      (double)spirv_bytes / (double)encoded_bytes,
+      best_seconds * 1000.0,
+      megabytes / best_seconds,
+      total_seconds * 1000.0 / iterations,
+      iterations);
+  return 0;
+}
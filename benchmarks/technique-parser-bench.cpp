@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Measures the throughput of the inline technique parser on large generated inputs.
+ *
+ * Usage: technique_parser_bench [input size in MB] [technique count] [iterations]
+ */
+
+#include "impl/technique-parser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+using namespace niceshade;
+
+namespace {
+
+// Produces HLSL-like text with the given number of technique definitions spread evenly across it.
+std::string generate_input(size_t size_bytes, uint32_t technique_count) {
+  static const char* filler_lines[] = {
+      "float4 PSMain(PSInput input) : SV_Target {\n",
+      "  float3 n = normalize(input.normal.xyz); // Normalize the interpolated normal.\n",
+      "  const float  ndotl = saturate(dot(n, u_LightDirection.xyz));\n",
+      "  return u_Texture.Sample(u_Sampler, input.uv * UVSCALE) * ndotl;\n",
+      "}\n",
+      "[[vk::binding(1, 0)]] uniform Texture2D u_Texture;\n",
+      "/* Block comment with a colon: and a slash / that is not a technique. */\n",
+      "\n"};
+  const size_t filler_count = sizeof(filler_lines) / sizeof(filler_lines[0]);
+  const size_t spacing      = size_bytes / (technique_count + 1u);
+  std::string  result;
+  result.reserve(size_bytes + 4096u);
+  uint32_t techniques_written = 0u;
+  for (size_t line = 0u; result.size() < size_bytes; ++line) {
+    if (techniques_written < technique_count && result.size() >= spacing * (techniques_written + 1u)) {
+      result += "//T: technique_" + std::to_string(techniques_written++) +
+                " vs:VSMain ps:PSMain define:UVSCALE=2.0 meta:blend=1\n";
+    }
+    result += filler_lines[line % filler_count];
+  }
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  const size_t   size_mb         = argc > 1 ? (size_t)strtoul(argv[1], nullptr, 10) : 8u;
+  const uint32_t technique_count = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 32u;
+  const uint32_t iterations      = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 20u;
+
+  const std::string      input = generate_input(size_mb * 1024u * 1024u, technique_count);
+  const input_blob       blob {reinterpret_cast<const std::byte*>(input.data()), input.size()};
+  const define_container global_defines {{"GLOBAL_DEFINE", "1"}};
+
+  double best_seconds = 1e9, total_seconds = 0.0;
+  for (uint32_t i = 0u; i < iterations; ++i) {
+    const auto start  = std::chrono::steady_clock::now();
+    auto       result = parse_techniques(blob, global_defines);
+    const auto end    = std::chrono::steady_clock::now();
+    if (result.is_error()) {
+      fprintf(stderr, "%s", result.error_message().c_str());
+      return 1;
+    }
+    if (result.get().size() != technique_count) {
+      fprintf(stderr, "expected %u techniques, got %zu\n", technique_count, result.get().size());
+      return 1;
+    }
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    best_seconds         = std::min(best_seconds, seconds);
+    total_seconds += seconds;
+  }
+
+  const double megabytes = (double)input.size() / (1024.0 * 1024.0);
+  printf(
+      "%.1f MB, %u techniques: best %.3f ms (%.0f MB/s), mean %.3f ms over %u iterations\n",
+      megabytes,
+      technique_count,
+      best_seconds * 1000.0,
+      megabytes / best_seconds,
+      total_seconds * 1000.0 / iterations,
+      iterations);
+  return 0;
+}
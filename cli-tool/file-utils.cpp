@@ -60,3 +60,25 @@ std::string read_file(const char *path) {
   fclose(input_file);
   return contents;
 }
+
+// Writes the given bytes to a file, replacing its contents.
+void write_file(const std::string &path, const void *data, size_t size) {
+  FILE *output_file = fopen(path.c_str(), "wb");
+  if (output_file == nullptr) {
+    fprintf(stderr, "Failed to open output file %s\n", path.c_str());
+    exit(1);
+  }
+  if (fwrite(data, 1u, size, output_file) != size) {
+    fprintf(stderr, "Failed to write file %s\n", path.c_str());
+    exit(1);
+  }
+  fclose(output_file);
+}
+
+// Appends a 32-bit value to a byte buffer in little-endian byte order.
+void append_le(std::vector<uint8_t> &out, uint32_t value) {
+  out.push_back((uint8_t)(value));
+  out.push_back((uint8_t)(value >> 8u));
+  out.push_back((uint8_t)(value >> 16u));
+  out.push_back((uint8_t)(value >> 24u));
+}
@@ -22,10 +22,17 @@
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
 #include <string>
+#include <vector>
 
 std::string read_file(const char *path);
 
+void write_file(const std::string &path, const void *data, size_t size);
+
+void append_le(std::vector<uint8_t> &out, uint32_t value);
+
 #if defined(_WIN32) || defined(_WIN64)
 #define PATH_SEPARATOR  "\\"
 #else
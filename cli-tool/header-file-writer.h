@@ -69,14 +69,14 @@ public:
       // names.
       const bool is_ubo = 
         d.type == niceshade::descriptor_type::UNIFORM_BUFFER;
-      const char *descriptor_name =
-          is_ubo && d.name.substr(0, 5) == "type." ? &d.name[5] : d.name.c_str();
+      const std::string descriptor_name {
+          is_ubo && d.name.substr(0, 5) == "type." ? d.name.substr(5) : d.name};
 
       fprintf(file_,
               "  static constexpr int %s_Binding = %d;\n"
               "  static constexpr int %s_Set = %d;\n",
-              descriptor_name, d.slot,
-              descriptor_name, set_id);
+              descriptor_name.c_str(), d.slot,
+              descriptor_name.c_str(), set_id);
     }
   }
   
@@ -22,6 +22,7 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include "metadata-file-writer.h"
+#include "cli-tool/file-utils.h"
 #include "libniceshade/impl/platform.h"
 
 #include <assert.h>
@@ -75,3 +76,69 @@ void metadata_file_writer::finalize() {
   fclose(f_);
   f_ = nullptr;
 }
+
+namespace {
+
+constexpr uint32_t native_header_size =
+    (uint32_t)(sizeof(ngf_plmd_native_header) + sizeof(ngf_plmd_section) * NGF_PLMD_SECTION_COUNT);
+
+}  // namespace
+
+void native_metadata_writer::align_data() {
+  data_.resize((data_.size() + 7u) & ~(size_t)7u, 0u);
+}
+
+void native_metadata_writer::begin_section(uint32_t section_id, uint32_t count) {
+  assert(section_id < NGF_PLMD_SECTION_COUNT && section_id != NGF_PLMD_SECTION_STRING_TABLE);
+  assert(current_section_ == ~0u || section_id > current_section_);
+  align_data();
+  current_section_             = section_id;
+  sections_[section_id].offset = native_header_size + (uint32_t)data_.size();
+  sections_[section_id].count  = count;
+}
+
+void native_metadata_writer::write_field(uint32_t value) {
+  assert(current_section_ < NGF_PLMD_SECTION_COUNT);
+  append_le(data_, value);
+  sections_[current_section_].size += 4u;
+}
+
+uint32_t native_metadata_writer::add_string(const std::string& str) {
+  auto [it, inserted] = string_offsets_.try_emplace(str, (uint32_t)strings_.size());
+  if (inserted) { strings_.append(str.c_str(), str.size() + 1u); }
+  return it->second;
+}
+
+std::vector<uint8_t> native_metadata_writer::finalize() {
+  // The native format is always little-endian, regardless of the host.
+  // Write out the string table.
+  align_data();
+  ngf_plmd_section& string_table = sections_[NGF_PLMD_SECTION_STRING_TABLE];
+  string_table.offset            = native_header_size + (uint32_t)data_.size();
+  string_table.size              = (uint32_t)strings_.size();
+  string_table.count             = (uint32_t)string_offsets_.size();
+  data_.insert(data_.end(), strings_.begin(), strings_.end());
+  align_data();
+
+  // Sections that have not been written are empty, but still need a valid offset.
+  for (ngf_plmd_section& section : sections_) {
+    if (section.offset == 0u) { section.offset = string_table.offset; }
+  }
+
+  std::vector<uint8_t> contents;
+  contents.reserve(native_header_size + data_.size());
+  append_le(contents, 0xdeadbeef);
+  append_le(contents, native_header_size);
+  append_le(contents, NGF_PLMD_NATIVE_VERSION_MAJ);
+  append_le(contents, NGF_PLMD_NATIVE_VERSION_MIN);
+  append_le(contents, NGF_PLMD_SECTION_COUNT);
+  append_le(contents, 0u);
+  for (const ngf_plmd_section& section : sections_) {
+    append_le(contents, section.offset);
+    append_le(contents, section.size);
+    append_le(contents, section.count);
+    append_le(contents, 0u);
+  }
+  contents.insert(contents.end(), data_.begin(), data_.end());
+  return contents;
+}
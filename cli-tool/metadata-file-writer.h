@@ -26,6 +26,9 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 // Convenience class for generating pipeline metadata in binary format.
 class metadata_file_writer {
@@ -51,3 +54,31 @@ private:
   uint32_t*       current_section_offset_ptr_;
   uint32_t        current_offset_ = sizeof(ngf_plmd_header);
 };
+
+// Convenience class for generating pipeline metadata in the native binary format. The metadata is
+// built in memory, so that it can be written out to a separate file or stored in a shader pack.
+class native_metadata_writer {
+public:
+  // Begin the section with the given id, which stores the given number of items. Sections must be
+  // begun in the order of their ids. The string table section is written by `finalize`.
+  void begin_section(uint32_t section_id, uint32_t count);
+
+  // Write a field into the current section.
+  void write_field(uint32_t value);
+
+  // Add a string to the string table, and return its offset within the table. Each distinct string
+  // is stored only once.
+  uint32_t add_string(const std::string& str);
+
+  // Finalize writing and return the contents of the metadata file.
+  std::vector<uint8_t> finalize();
+
+private:
+  void align_data();
+
+  ngf_plmd_section                          sections_[NGF_PLMD_SECTION_COUNT] = {};
+  uint32_t                                  current_section_                  = ~0u;
+  std::vector<uint8_t>                      data_;
+  std::string                               strings_;
+  std::unordered_map<std::string, uint32_t> string_offsets_;
+};
@@ -27,16 +27,20 @@
 #include "cli-tool/file-utils.h"
 #include "cli-tool/header-file-writer.h"
 #include "cli-tool/metadata-file-writer.h"
+#include "cli-tool/shader-pack-writer.h"
 #include "cli-tool/target-list.h"
-#include "spirv_reflect.hpp"
+#include "spirv-codec/spirv-codec.h"
 
+#include <algorithm>
 #include <ctype.h>
 #include <memory>
+#include <memory_resource>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
+#include <tuple>
 #include <vector>
 
 using namespace niceshade;
@@ -77,6 +81,37 @@ Options:
  
   -p <yes|no> - Wheter to reserve unused bindings in the generated SPIR-V and pipeline template data (default behavior is NO). 
 
+  -r <count> - Print a warning for every shader that takes SPIRV-Cross more than `count`
+     code generation passes to produce. Default is 0, which disables the warning.
+
+  -s <yes|no> - Whether to print compilation statistics for each generated shader to the
+     standard output (default behavior is NO).
+
+  -l <yes|no> - Whether to compile techniques with multiple entry points using a single DXC
+     invocation with a library target profile (default behavior is NO). Entry points must be
+     marked with the `[shader("<stage>")]` attribute, and shader model 6_3 or higher is required.
+     Each SPIR-V output holds the whole library module, and unused resources are not preserved.
+
+  -c <yes|no> - Whether to cross-compile shaders (default behavior is YES). If NO, only the
+     pipeline metadata files and the header file are generated.
+
+  -g <yes|no> - Whether to keep debug instructions (names, source and line information) in
+     SPIR-V output (default behavior is YES). If NO, they are stripped after reflection, so the
+     pipeline metadata and the header file are unaffected, and the number of bytes saved is
+     printed for each technique.
+
+  -a <path> - Path (relative to the output folder) for a shader pack. If specified, the shaders
+     and pipeline metadata for all techniques and targets are stored in this single file, with
+     an index for looking up techniques by name, instead of in separate files.
+
+  -f <0|1> - Version of the pipeline metadata file format to write. 1 (the default) is the
+     native format, which can be memory-mapped and used without conversion on little-endian
+     hosts. 0 is the legacy big-endian format.
+
+  -z <yes|no> - Whether to encode SPIR-V shaders with a SPIR-V-specific lossless encoding that
+     makes them smaller (default behavior is NO). Encoded shaders have the `spvz` extension, and
+     can be decoded with the code in the `spirv-codec` folder.
+
    Everything following the double dash (`--`) is passed as-is to the
    Microsoft DirectX Shader Compiler.
 
@@ -86,6 +121,404 @@ void report_dxc_error(const char* msg, size_t size) {
   fprintf(stderr, "DXC diagnostic message:\n%.*s\n", (unsigned int)size, msg);
 }
 
+void write_legacy_pipeline_metadata(
+    const std::string&                            file_path,
+    const technique_desc&                         tech,
+    const compiled_technique&                     compiled_tech,
+    const std::optional<std::array<uint32_t, 3>>& maybe_threadgroup_size) {
+  const pipeline_layout& res_layout = compiled_tech.layout;
+  metadata_file_writer   metadata_file(file_path.c_str());
+
+  // Write out the entrypoints section.
+  metadata_file.start_new_record();
+  metadata_file.write_field((uint32_t)tech.entry_points.size());
+  for (const technique_desc::entry_point& ep : tech.entry_points) {
+    metadata_file.write_field((uint32_t)ep.stage);
+    metadata_file.write_raw_bytes(ep.name.c_str(), ep.name.length() + 1u);
+  }
+
+  // Write out the pipeline layout record.
+  metadata_file.start_new_record();
+  metadata_file.write_field(res_layout.set_count());
+  for (uint32_t set = 0u; set < res_layout.set_count(); ++set) {
+    const descriptor_set_layout ds = res_layout.set(set);
+    metadata_file.write_field((uint32_t)ds.size());
+    for (const descriptor& d : ds) {
+      metadata_file.write_field(d.slot);
+      metadata_file.write_field((uint32_t)d.type);
+      metadata_file.write_field(d.stage_mask);
+    }
+  }
+
+  // Write out separate-to-combined map records.
+  auto serialize_separate_to_combined_map =
+      [&metadata_file](const separate_to_combined_map& map) {
+        metadata_file.start_new_record();
+        metadata_file.write_field((uint32_t)map.size());
+        for (const separate_to_combined_map::value_type& entry : map) {
+          const set_and_binding&      sb                      = entry.resource;
+          const const_span<uint32_t>& combined_image_samplers = entry.combined_ids;
+          metadata_file.write_field(sb.set);
+          metadata_file.write_field(sb.binding);
+          metadata_file.write_field((uint32_t)combined_image_samplers.size());
+          for (const auto& c : combined_image_samplers) { metadata_file.write_field(c); }
+        }
+      };
+  serialize_separate_to_combined_map(compiled_tech.image_map);
+  serialize_separate_to_combined_map(compiled_tech.sampler_map);
+
+  // Write out user metadata record.
+  metadata_file.start_new_record();
+  metadata_file.write_field((uint32_t)tech.additional_metadata.size());
+  for (const auto& nameval : tech.additional_metadata) {
+    metadata_file.write_raw_bytes(nameval.first.c_str(), nameval.first.size() + 1u);
+    metadata_file.write_raw_bytes(nameval.second.c_str(), nameval.second.size() + 1u);
+  }
+
+  // Write out threadgroup size for compute shader
+  metadata_file.start_new_record();
+  if (maybe_threadgroup_size) {
+    metadata_file.write_field(maybe_threadgroup_size.value()[0]);
+    metadata_file.write_field(maybe_threadgroup_size.value()[1]);
+    metadata_file.write_field(maybe_threadgroup_size.value()[2]);
+  } else {
+    metadata_file.write_field(0u);
+    metadata_file.write_field(0u);
+    metadata_file.write_field(0u);
+  }
+
+  metadata_file.finalize();
+}
+
+// Perfect hash table of descriptor names, built with the hash-and-displace method. Names are
+// distributed into buckets by their hash. Then, starting from the largest bucket, each bucket is
+// assigned the first displacement that, used as the seed of the hash, maps all of its names to free
+// slots. The table needs about as many slots as there are names.
+struct descriptor_name_hash {
+  std::vector<uint32_t> displacements;  // Indexed by bucket.
+  std::vector<uint32_t> slots;          // Index of each slot's name, or NGF_PLMD_NO_DESCRIPTOR.
+};
+
+descriptor_name_hash build_descriptor_name_hash(const std::vector<std::string>& names) {
+  // Empty names can not be looked up, and only the first of several equal names can be.
+  std::vector<uint32_t> keys;
+  for (uint32_t n = 0u; n < names.size(); ++n) {
+    if (!names[n].empty() && std::find(names.begin(), names.begin() + n, names[n]) ==
+                                 names.begin() + n) {
+      keys.push_back(n);
+    }
+  }
+  descriptor_name_hash result;
+  if (keys.empty()) { return result; }
+
+  constexpr uint32_t max_displacement = 1u << 16u;
+  const uint32_t     nbuckets         = ((uint32_t)keys.size() + 3u) / 4u;
+  std::vector<std::vector<uint32_t>> buckets(nbuckets);
+  for (uint32_t k : keys) {
+    buckets[ngf_plmd_hash_name(names[k].c_str(), 0u) % nbuckets].push_back(k);
+  }
+  std::vector<uint32_t> bucket_order(nbuckets);
+  for (uint32_t b = 0u; b < nbuckets; ++b) { bucket_order[b] = b; }
+  std::stable_sort(
+      bucket_order.begin(),
+      bucket_order.end(),
+      [&buckets](uint32_t lhs, uint32_t rhs) { return buckets[lhs].size() > buckets[rhs].size(); });
+
+  // Searching for displacements can fail for unlucky sets of names, in which case the table is
+  // grown by a slot and the search restarted.
+  for (uint32_t nslots = (uint32_t)keys.size();; ++nslots) {
+    result.displacements.assign(nbuckets, 0u);
+    result.slots.assign(nslots, NGF_PLMD_NO_DESCRIPTOR);
+    bool                  found_all = true;
+    std::vector<uint32_t> bucket_slots;
+    for (uint32_t b : bucket_order) {
+      bool found = buckets[b].empty();
+      for (uint32_t d = 0u; !found && d < max_displacement; ++d) {
+        bucket_slots.clear();
+        found = true;
+        for (uint32_t k : buckets[b]) {
+          const uint32_t slot = ngf_plmd_hash_name(names[k].c_str(), d) % nslots;
+          if (result.slots[slot] != NGF_PLMD_NO_DESCRIPTOR ||
+              std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end()) {
+            found = false;
+            break;
+          }
+          bucket_slots.push_back(slot);
+        }
+        if (found) {
+          result.displacements[b] = d;
+          for (uint32_t i = 0u; i < bucket_slots.size(); ++i) {
+            result.slots[bucket_slots[i]] = buckets[b][i];
+          }
+        }
+      }
+      if (!found) {
+        found_all = false;
+        break;
+      }
+    }
+    if (found_all) { return result; }
+  }
+}
+
+std::vector<uint8_t> build_native_pipeline_metadata(
+    const technique_desc&                         tech,
+    const compiled_technique&                     compiled_tech,
+    const std::optional<std::array<uint32_t, 3>>& maybe_threadgroup_size) {
+  const pipeline_layout& res_layout = compiled_tech.layout;
+  native_metadata_writer metadata_file;
+
+  // Write out the entrypoints section.
+  metadata_file.begin_section(NGF_PLMD_SECTION_ENTRYPOINTS, (uint32_t)tech.entry_points.size());
+  for (const technique_desc::entry_point& ep : tech.entry_points) {
+    metadata_file.write_field((uint32_t)ep.stage);
+    metadata_file.write_field(metadata_file.add_string(ep.name));
+  }
+
+  // Write out the pipeline layout section. Descriptor set layouts are preceded by a table of their
+  // offsets within the section.
+  metadata_file.begin_section(NGF_PLMD_SECTION_PIPELINE_LAYOUT, res_layout.set_count());
+  uint32_t set_offset = res_layout.set_count() * (uint32_t)sizeof(uint32_t);
+  for (uint32_t set = 0u; set < res_layout.set_count(); ++set) {
+    metadata_file.write_field(set_offset);
+    set_offset += (uint32_t)(sizeof(uint32_t) +
+                             res_layout.set(set).size() * sizeof(ngf_plmd_descriptor));
+  }
+  for (uint32_t set = 0u; set < res_layout.set_count(); ++set) {
+    const descriptor_set_layout ds = res_layout.set(set);
+    metadata_file.write_field((uint32_t)ds.size());
+    for (const descriptor& d : ds) {
+      metadata_file.write_field(d.slot);
+      metadata_file.write_field((uint32_t)d.type);
+      metadata_file.write_field(d.stage_mask);
+    }
+  }
+
+  // Write out separate-to-combined map sections. Entries are preceded by a table of their offsets
+  // within the section.
+  auto serialize_separate_to_combined_map =
+      [&metadata_file](uint32_t section_id, const separate_to_combined_map& map) {
+        metadata_file.begin_section(section_id, (uint32_t)map.size());
+        uint32_t entry_offset = (uint32_t)(map.size() * sizeof(uint32_t));
+        for (const separate_to_combined_map::value_type& entry : map) {
+          metadata_file.write_field(entry_offset);
+          entry_offset += (uint32_t)(sizeof(ngf_plmd_cis_map_entry) +
+                                     entry.combined_ids.size() * sizeof(uint32_t));
+        }
+        for (const separate_to_combined_map::value_type& entry : map) {
+          metadata_file.write_field(entry.resource.set);
+          metadata_file.write_field(entry.resource.binding);
+          metadata_file.write_field((uint32_t)entry.combined_ids.size());
+          for (const auto& c : entry.combined_ids) { metadata_file.write_field(c); }
+        }
+      };
+  serialize_separate_to_combined_map(NGF_PLMD_SECTION_IMAGE_TO_CIS_MAP, compiled_tech.image_map);
+  serialize_separate_to_combined_map(
+      NGF_PLMD_SECTION_SAMPLER_TO_CIS_MAP,
+      compiled_tech.sampler_map);
+
+  // Write out the user metadata section.
+  metadata_file.begin_section(
+      NGF_PLMD_SECTION_USER_METADATA,
+      (uint32_t)tech.additional_metadata.size());
+  for (const auto& nameval : tech.additional_metadata) {
+    metadata_file.write_field(metadata_file.add_string(nameval.first));
+    metadata_file.write_field(metadata_file.add_string(nameval.second));
+  }
+
+  // Write out threadgroup size for compute shader.
+  metadata_file.begin_section(NGF_PLMD_SECTION_THREADGROUP_SIZE, 1u);
+  for (uint32_t i = 0u; i < 3u; ++i) {
+    metadata_file.write_field(maybe_threadgroup_size ? maybe_threadgroup_size.value()[i] : 0u);
+  }
+
+  // Write out the native binding map section. It starts with the native binding of push constants,
+  // followed by a table of the offsets of the descriptor sets within the section. Each set stores
+  // the native bindings of its slots densely, with holes marked as having no native binding.
+  metadata_file.begin_section(NGF_PLMD_SECTION_NATIVE_BINDING_MAP, res_layout.set_count());
+  metadata_file.write_field(
+      res_layout.push_consts_native_binding().value_or(NGF_PLMD_NO_NATIVE_BINDING));
+  std::vector<std::vector<uint32_t>> native_binding_sets(res_layout.set_count());
+  set_offset = (1u + res_layout.set_count()) * (uint32_t)sizeof(uint32_t);
+  for (uint32_t set = 0u; set < res_layout.set_count(); ++set) {
+    std::vector<uint32_t>& native_bindings = native_binding_sets[set];
+    for (const descriptor& d : res_layout.set(set)) {
+      if (d.slot >= native_bindings.size()) {
+        native_bindings.resize(d.slot + 1u, NGF_PLMD_NO_NATIVE_BINDING);
+      }
+      native_bindings[d.slot] = d.native_binding;
+    }
+    metadata_file.write_field(set_offset);
+    set_offset += (uint32_t)((1u + native_bindings.size()) * sizeof(uint32_t));
+  }
+  for (const std::vector<uint32_t>& native_bindings : native_binding_sets) {
+    metadata_file.write_field((uint32_t)native_bindings.size());
+    for (uint32_t native_binding : native_bindings) { metadata_file.write_field(native_binding); }
+  }
+
+  // Write out the descriptor counts section: counts for the whole pipeline, followed by counts for
+  // each set. Every element of a descriptor array is counted. Arrays whose size is not known at
+  // compile time (runtime-sized, or sized by a specialization constant) are only flagged.
+  std::vector<ngf_plmd_descriptor_counts> descriptor_counts(
+      1u + res_layout.set_count(),
+      ngf_plmd_descriptor_counts {});
+  for (uint32_t set = 0u; set < res_layout.set_count(); ++set) {
+    for (const descriptor& d : res_layout.set(set)) {
+      const uint32_t                    type = (uint32_t)d.type;
+      ngf_plmd_descriptor_counts* const pipeline_and_set_counts[] = {
+          &descriptor_counts[0],
+          &descriptor_counts[1u + set]};
+      for (ngf_plmd_descriptor_counts* counts : pipeline_and_set_counts) {
+        if (d.is_array && (d.array_size == 0u || d.array_size == ~0u)) {
+          counts->unbounded_types |= 1u << type;
+        } else {
+          counts->counts[type] += d.is_array ? d.array_size : 1u;
+        }
+      }
+    }
+  }
+  metadata_file.begin_section(NGF_PLMD_SECTION_DESCRIPTOR_COUNTS, res_layout.set_count());
+  for (const ngf_plmd_descriptor_counts& counts : descriptor_counts) {
+    for (uint32_t count : counts.counts) { metadata_file.write_field(count); }
+    metadata_file.write_field(counts.unbounded_types);
+  }
+
+  // Write out the interface variables section, sorted by stage, then by direction, then by
+  // location. Variables without a location, like built-ins, come last.
+  struct interface_var_item {
+    uint32_t                  stage;
+    uint32_t                  direction;
+    const interface_variable* var;
+  };
+  std::vector<interface_var_item> interface_vars;
+  for (const interface_variables& stage_vars : compiled_tech.per_stage_interface) {
+    for (const interface_variable& v : stage_vars.input_vars) {
+      interface_vars.push_back({(uint32_t)stage_vars.stage, NGF_PLMD_INTERFACE_INPUT, &v});
+    }
+    for (const interface_variable& v : stage_vars.output_vars) {
+      interface_vars.push_back({(uint32_t)stage_vars.stage, NGF_PLMD_INTERFACE_OUTPUT, &v});
+    }
+  }
+  std::sort(
+      interface_vars.begin(),
+      interface_vars.end(),
+      [](const interface_var_item& lhs, const interface_var_item& rhs) {
+        return std::tie(lhs.stage, lhs.direction, lhs.var->location_decoration, lhs.var->name) <
+               std::tie(rhs.stage, rhs.direction, rhs.var->location_decoration, rhs.var->name);
+      });
+  metadata_file.begin_section(NGF_PLMD_SECTION_INTERFACE_VARS, (uint32_t)interface_vars.size());
+  for (const interface_var_item& item : interface_vars) {
+    metadata_file.write_field(item.stage);
+    metadata_file.write_field(item.direction);
+    metadata_file.write_field(metadata_file.add_string(std::string {item.var->name}));
+    metadata_file.write_field((uint32_t)item.var->base_type);
+    metadata_file.write_field(item.var->vecsize);
+    metadata_file.write_field(item.var->location_decoration);
+  }
+
+  // Write out the block layouts section. It starts with the total number of block members, followed
+  // by a table of the offsets of the blocks within the section. Blocks are sorted by set and
+  // binding, and the push constant block comes last.
+  struct keyed_block {
+    uint32_t     set;
+    uint32_t     binding;
+    block_layout layout;
+  };
+  std::vector<keyed_block> blocks;
+  for (const descriptor_set_layout& set_layout : res_layout) {
+    for (const descriptor& d : set_layout) {
+      if (const std::optional<block_layout> block = res_layout.buffer_block(d)) {
+        blocks.push_back({set_layout.set_id(), d.slot, *block});
+      }
+    }
+  }
+  if (const std::optional<block_layout> block = res_layout.push_consts_block()) {
+    blocks.push_back({NGF_PLMD_PUSH_CONSTANTS_SET, NGF_PLMD_PUSH_CONSTANTS_BINDING, *block});
+  }
+  metadata_file.begin_section(NGF_PLMD_SECTION_BLOCK_LAYOUTS, (uint32_t)blocks.size());
+  uint32_t nblock_members = 0u;
+  for (const keyed_block& block : blocks) {
+    nblock_members += (uint32_t)block.layout.members.size();
+  }
+  metadata_file.write_field(nblock_members);
+  uint32_t block_offset = (1u + (uint32_t)blocks.size()) * (uint32_t)sizeof(uint32_t);
+  for (const keyed_block& block : blocks) {
+    metadata_file.write_field(block_offset);
+    block_offset += (uint32_t)(4u * sizeof(uint32_t) + block.layout.members.size() *
+                                                           sizeof(ngf_plmd_native_block_member));
+  }
+  for (const keyed_block& block : blocks) {
+    metadata_file.write_field(block.set);
+    metadata_file.write_field(block.binding);
+    metadata_file.write_field(block.layout.size);
+    metadata_file.write_field((uint32_t)block.layout.members.size());
+    for (const block_member& member : block.layout.members) {
+      metadata_file.write_field(metadata_file.add_string(std::string {member.name}));
+      metadata_file.write_field(member.offset);
+      metadata_file.write_field(member.size);
+      metadata_file.write_field(member.vecsize);
+      metadata_file.write_field(member.columns);
+      metadata_file.write_field(member.is_array ? member.array_size : 0u);
+      metadata_file.write_field(member.array_stride);
+      metadata_file.write_field(member.matrix_stride);
+      metadata_file.write_field(member.row_major ? NGF_PLMD_BLOCK_MEMBER_ROW_MAJOR_BIT : 0u);
+    }
+  }
+
+  // Write out the descriptor index section. It starts with the number of hash buckets, the number
+  // of hash slots and the number of sets, followed by the names of the descriptors, the perfect
+  // hash table of the names and a table of the offsets of the sets within the section. Each set
+  // stores the indices of the descriptors in its slots densely, with holes marked as having no
+  // descriptor.
+  struct indexed_descriptor {
+    uint32_t set;
+    uint32_t index;
+  };
+  std::vector<indexed_descriptor>    indexed_descriptors;
+  std::vector<std::string>           descriptor_names;
+  std::vector<std::vector<uint32_t>> descriptor_tables(res_layout.set_count());
+  for (uint32_t set = 0u; set < res_layout.set_count(); ++set) {
+    std::vector<uint32_t>& table = descriptor_tables[set];
+    uint32_t               index = 0u;
+    for (const descriptor& d : res_layout.set(set)) {
+      if (d.slot >= table.size()) { table.resize(d.slot + 1u, NGF_PLMD_NO_DESCRIPTOR); }
+      table[d.slot] = (uint32_t)indexed_descriptors.size();
+      indexed_descriptors.push_back({set, index++});
+      descriptor_names.emplace_back(d.name);
+    }
+  }
+  const descriptor_name_hash name_hash = build_descriptor_name_hash(descriptor_names);
+  metadata_file.begin_section(
+      NGF_PLMD_SECTION_DESCRIPTOR_INDEX,
+      (uint32_t)indexed_descriptors.size());
+  metadata_file.write_field((uint32_t)name_hash.displacements.size());
+  metadata_file.write_field((uint32_t)name_hash.slots.size());
+  metadata_file.write_field(res_layout.set_count());
+  for (uint32_t i = 0u; i < indexed_descriptors.size(); ++i) {
+    metadata_file.write_field(indexed_descriptors[i].set);
+    metadata_file.write_field(indexed_descriptors[i].index);
+    metadata_file.write_field(metadata_file.add_string(descriptor_names[i]));
+    metadata_file.write_field(ngf_plmd_hash_name(descriptor_names[i].c_str(), 0u));
+  }
+  for (uint32_t displacement : name_hash.displacements) {
+    metadata_file.write_field(displacement);
+  }
+  for (uint32_t slot : name_hash.slots) { metadata_file.write_field(slot); }
+  set_offset = (uint32_t)((3u + indexed_descriptors.size() * 4u + name_hash.displacements.size() +
+                           name_hash.slots.size() + res_layout.set_count()) *
+                          sizeof(uint32_t));
+  for (const std::vector<uint32_t>& table : descriptor_tables) {
+    metadata_file.write_field(set_offset);
+    set_offset += (uint32_t)((1u + table.size()) * sizeof(uint32_t));
+  }
+  for (const std::vector<uint32_t>& table : descriptor_tables) {
+    metadata_file.write_field((uint32_t)table.size());
+    for (uint32_t index : table) { metadata_file.write_field(index); }
+  }
+
+  return metadata_file.finalize();
+}
+
 int main(int argc, const char* argv[]) {
   if (argc <= 1) {  // Display help if invoked with no arguments.
     printf("%s\n", USAGE);
@@ -97,11 +530,19 @@ int main(int argc, const char* argv[]) {
   // Everything after the double dash will be passed as-is to
   // Microsoft DirectX Shader Compiler.
   const std::string        input_file_path {argv[1]};
-  std::string              out_folder        = ".";
-  std::string              header_path       = "";
-  std::string              header_namespace  = "";
-  std::string              shader_model      = "6_2";
-  bool                     preserve_bindings = false;
+  std::string              out_folder                     = ".";
+  std::string              header_path                    = "";
+  std::string              header_namespace               = "";
+  std::string              shader_model                   = "6_2";
+  bool                     preserve_bindings              = false;
+  uint32_t                 codegen_pass_warning_threshold = 0u;
+  bool                     print_stats                    = false;
+  bool                     compile_as_libraries           = false;
+  bool                     reflection_only                = false;
+  bool                     strip_debug_info               = false;
+  uint32_t                 metadata_format_version        = NGF_PLMD_NATIVE_VERSION_MAJ;
+  std::string              pack_path                      = "";
+  bool                     encode_spirv                   = false;
   std::vector<target_desc> targets;
   define_container         global_macro_definitions;
   size_t                   dxc_options_start = argc;
@@ -160,6 +601,29 @@ int main(int argc, const char* argv[]) {
         global_macro_definitions.emplace_back(option_value, std::string());
     } else if ("-p" == option_name) {
       preserve_bindings = option_value == "yes";
+    } else if ("-r" == option_name) {
+      codegen_pass_warning_threshold = (uint32_t)strtoul(option_value.c_str(), nullptr, 10);
+    } else if ("-s" == option_name) {
+      print_stats = option_value == "yes";
+    } else if ("-l" == option_name) {
+      compile_as_libraries = option_value == "yes";
+    } else if ("-c" == option_name) {
+      reflection_only = option_value == "no";
+    } else if ("-g" == option_name) {
+      strip_debug_info = option_value == "no";
+    } else if ("-a" == option_name) {
+      pack_path = option_value;
+    } else if ("-z" == option_name) {
+      encode_spirv = option_value == "yes";
+    } else if ("-f" == option_name) {
+      if (option_value == "0") {
+        metadata_format_version = NGF_PLMD_LEGACY_VERSION_MAJ;
+      } else if (option_value == "1") {
+        metadata_format_version = NGF_PLMD_NATIVE_VERSION_MAJ;
+      } else {
+        fprintf(stderr, "Unsupported pipeline metadata format: \"%s\"\n", option_value.c_str());
+        exit(1);
+      }
     } else {
       fprintf(stderr, "Unknown option: \"%s\"\n", option_name.c_str());
       exit(1);
@@ -184,6 +648,12 @@ int main(int argc, const char* argv[]) {
     exit(1);
   }
 
+  // Shader packs are meant to be read in place, so they always store native metadata.
+  if (!pack_path.empty() && metadata_format_version != NGF_PLMD_NATIVE_VERSION_MAJ) {
+    fprintf(stderr, "Shader packs can only be written with the native metadata format.\n");
+    exit(1);
+  }
+
   // Make sure targets are always processed in the same order, no matter
   // what order they're specified in.
   std::sort(targets.begin(), targets.end(), [](const target_desc& t1, const target_desc& t2) {
@@ -194,27 +664,32 @@ int main(int argc, const char* argv[]) {
   const std::string exe_path(argv[0]);
   const std::string exe_dir = exe_path.substr(0, exe_path.find_last_of("/\\"));
 
-  // Load the input file.
-  std::string input_source = read_file(input_file_path.c_str());
-  input_source.push_back('\n');
-
   value_or_error<instance> maybe_inst = instance::create(instance::options {
       shader_model,
       span<std::string> {dxc_options.data(), dxc_options.size()},
       exe_dir,
       report_dxc_error,
-      preserve_bindings});
+      preserve_bindings,
+      codegen_pass_warning_threshold,
+      compile_as_libraries,
+      reflection_only,
+      {},
+      strip_debug_info});
   if (maybe_inst.is_error()) {
     fprintf(stderr, "%s", maybe_inst.error_message().c_str());
     exit(1);
   }
   instance& inst = maybe_inst.get();
 
-  auto maybe_results = inst.parse_techniques_and_compile(
-      const_span<std::byte> {(std::byte*)input_source.data(), input_source.size()},
+  // All results are released together at exit, so allocate them from an arena.
+  std::pmr::monotonic_buffer_resource compile_arena;
+
+  // The input file is mapped into memory rather than read into a separate buffer.
+  auto maybe_results = inst.parse_techniques_and_compile_file(
       input_file_path.c_str(),
       const_span<target_desc> {targets.data(), targets.size()},
-      global_macro_definitions);
+      global_macro_definitions,
+      &compile_arena);
   if (maybe_results.is_error()) {
     fprintf(stderr, "%s", maybe_results.error_message().c_str());
     exit(1);
@@ -234,6 +709,9 @@ int main(int argc, const char* argv[]) {
     exit(1);
   }
 
+  const bool         generate_pack = !pack_path.empty();
+  shader_pack_writer pack_writer;
+
   for (const technique_desc& tech : technique_descs) {
     const size_t              tech_idx      = &tech - technique_descs.data();
     const compiled_technique& compiled_tech = compiled_techs[tech_idx];
@@ -241,10 +719,17 @@ int main(int argc, const char* argv[]) {
 
     std::string                            out_file_path = out_folder + PATH_SEPARATOR + tech.name;
     std::optional<std::array<uint32_t, 3>> maybe_threadgroup_size;
+    uint32_t                               stripped_debug_bytes = 0u;
+    if (generate_pack) { pack_writer.begin_technique(tech.name); }
 
     for (const targeted_output& target_out : compiled_tech.targeted_outputs) {
       std::string native_binding_map_str;
       for (const compiled_stage& out_stage : target_out.stages) {
+        if (out_stage.stage == pipeline_stage::compute) {
+          maybe_threadgroup_size = out_stage.threadgroup_size;
+        }
+        if (reflection_only) { continue; }
+        stripped_debug_bytes += out_stage.stats.stripped_debug_bytes;
         const std::string ep_extension = [](pipeline_stage s) {
           switch (s) {
           case pipeline_stage::vertex: return ".vs.";
@@ -253,22 +738,32 @@ int main(int argc, const char* argv[]) {
           }
           return "";
         }(out_stage.stage);
-        const std::string full_out_file_path =
-            out_file_path + ep_extension + file_ext_for_target(target_out.target);
-        FILE* out_file = fopen(full_out_file_path.c_str(), "wb");
-        if (out_file == nullptr) {
-          fprintf(stderr, "Failed to open output file %s\n", out_file_path.c_str());
-          exit(1);
+        const bool encode_shader = encode_spirv && target_out.target.api == target_api::VULKAN;
+        const std::string target_ext =
+            encode_shader ? std::string("spvz") : file_ext_for_target(target_out.target);
+        const std::string full_out_file_path = out_file_path + ep_extension + target_ext;
+        if (print_stats) {
+          printf(
+              "%s%s%s: %u code generation passes\n",
+              tech.name.c_str(),
+              ep_extension.c_str(),
+              target_ext.c_str(),
+              out_stage.stats.codegen_passes);
         }
-        fwrite(out_stage.result.data().begin(), 1u, out_stage.result.data().size(), out_file);
-        if (target_out.target.api != target_api::VULKAN) {
+        std::string shader_code {
+            (const char*)out_stage.result.data().begin(),
+            out_stage.result.data().size()};
+        // The native metadata format stores the native binding map in a binary form. For the legacy
+        // format, it is appended to the shader code as a comment.
+        if (target_out.target.api != target_api::VULKAN &&
+            metadata_format_version == NGF_PLMD_LEGACY_VERSION_MAJ) {
           if (native_binding_map_str.empty()) {
             std::ostringstream os;
             os << "/**NGF_NATIVE_BINDING_MAP\n";
-            for (const auto& set_id_and_layout : compiled_tech.layout) {
-              for (const auto& binding_id_and_descriptor : set_id_and_layout.second) {
-                os << "(" << set_id_and_layout.first << " " << binding_id_and_descriptor.first
-                   << ") : " << binding_id_and_descriptor.second.native_binding << "\n";
+            for (const descriptor_set_layout& set_layout : compiled_tech.layout) {
+              for (const descriptor& desc : set_layout) {
+                os << "(" << set_layout.set_id() << " " << desc.slot << ") : "
+                   << desc.native_binding << "\n";
               }
             }
             os << "(-1 -1) : -1\n";
@@ -280,7 +775,7 @@ int main(int argc, const char* argv[]) {
             os << "\n**/\n";
             native_binding_map_str = os.str();
           }
-          fwrite(native_binding_map_str.data(), 1u, native_binding_map_str.size(), out_file);
+          shader_code += native_binding_map_str;
         }
         if (out_stage.stage == pipeline_stage::compute) {
           if (target_out.target.api == target_api::METAL) {
@@ -288,87 +783,78 @@ int main(int argc, const char* argv[]) {
               fprintf(stderr, "failed to find threadgroup size for compute shader");
               exit(1);
             }
-            fprintf(
-                out_file,
+            char threadgroup_size_str[64];
+            snprintf(
+                threadgroup_size_str,
+                sizeof(threadgroup_size_str),
                 "/**NGF_THREADGROUP_SIZE %d %d %d */\n",
                 out_stage.threadgroup_size.value()[0],
                 out_stage.threadgroup_size.value()[1],
                 out_stage.threadgroup_size.value()[2]);
+            shader_code += threadgroup_size_str;
           }
-          maybe_threadgroup_size = out_stage.threadgroup_size;
         }
-        fclose(out_file);
+        if (encode_shader) {
+          std::string    encoded_code(ngf_spvz_encode_bound(shader_code.size()), '\0');
+          size_t         encoded_size = encoded_code.size();
+          ngf_spvz_error err          = ngf_spvz_encode(
+              (const uint32_t*)out_stage.result.data().begin(),
+              shader_code.size(),
+              (uint8_t*)encoded_code.data(),
+              &encoded_size);
+          if (err != NGF_SPVZ_ERROR_OK) {
+            fprintf(
+                stderr,
+                "Failed to encode %s: %s\n",
+                full_out_file_path.c_str(),
+                ngf_spvz_get_error_name(err));
+            exit(1);
+          }
+          encoded_code.resize(encoded_size);
+          shader_code = std::move(encoded_code);
+        }
+        if (generate_pack) {
+          pack_writer.add_shader((uint32_t)out_stage.stage, target_ext, std::move(shader_code));
+        } else {
+          write_file(full_out_file_path, shader_code.data(), shader_code.size());
+        }
       }
     }
 
-    // Write out the .pipeline file for the current technique.
-    std::string          metadata_file_path = out_folder + PATH_SEPARATOR + tech.name + ".pipeline";
-    metadata_file_writer metadata_file(metadata_file_path.c_str());
-    header_writer.begin_technique(tech.name);
-
-    // Write out the entrypoints section.
-    metadata_file.start_new_record();
-    metadata_file.write_field((uint32_t)tech.entry_points.size());
-    for (const technique_desc::entry_point& ep : tech.entry_points) {
-      metadata_file.write_field((uint32_t)ep.stage);
-      metadata_file.write_raw_bytes(ep.name.c_str(), ep.name.length() + 1u);
+    if (strip_debug_info && !reflection_only) {
+      printf(
+          "%s: stripped %u bytes of debug instructions from SPIR-V\n",
+          tech.name.c_str(),
+          stripped_debug_bytes);
     }
 
-    // Write out the pipeline layout record.
-    metadata_file.start_new_record();
-    metadata_file.write_field(res_layout.set_count());
-    for (uint32_t set = 0u; set < res_layout.set_count(); ++set) {
-      const descriptor_set_layout& ds = res_layout.set(set);
-      metadata_file.write_field((uint32_t)ds.size());
-      for (const auto& d : ds) {
-        metadata_file.write_field(d.second.slot);
-        metadata_file.write_field((uint32_t)d.second.type);
-        metadata_file.write_field(d.second.stage_mask);
-        header_writer.write_descriptor(d.second, set);
+    // Write out the .pipeline file for the current technique.
+    const std::string metadata_file_path = out_folder + PATH_SEPARATOR + tech.name + ".pipeline";
+    if (metadata_format_version == NGF_PLMD_LEGACY_VERSION_MAJ) {
+      write_legacy_pipeline_metadata(
+          metadata_file_path,
+          tech,
+          compiled_tech,
+          maybe_threadgroup_size);
+    } else {
+      std::vector<uint8_t> metadata =
+          build_native_pipeline_metadata(tech, compiled_tech, maybe_threadgroup_size);
+      if (generate_pack) {
+        pack_writer.set_metadata(std::move(metadata));
+      } else {
+        write_file(metadata_file_path, metadata.data(), metadata.size());
       }
     }
 
-    header_writer.end_technique();
-
-    // Write out separate-to-combined map records.
-    auto serialize_separate_to_combined_map =
-        [&metadata_file](const separate_to_combined_map& map) {
-          metadata_file.start_new_record();
-          metadata_file.write_field((uint32_t)map.size());
-          for (const auto& entry : map) {
-            const set_and_binding&    sb                      = entry.first;
-            const std::set<uint32_t>& combined_image_samplers = entry.second;
-            metadata_file.write_field(sb.set);
-            metadata_file.write_field(sb.binding);
-            metadata_file.write_field((uint32_t)combined_image_samplers.size());
-            for (const auto& c : combined_image_samplers) { metadata_file.write_field(c); }
-          }
-        };
-    serialize_separate_to_combined_map(compiled_tech.image_map);
-    serialize_separate_to_combined_map(compiled_tech.sampler_map);
-
-    // Write out user metadata record.
-    metadata_file.start_new_record();
-    metadata_file.write_field((uint32_t)tech.additional_metadata.size());
-    for (const auto& nameval : tech.additional_metadata) {
-      metadata_file.write_raw_bytes(nameval.first.c_str(), nameval.first.size() + 1u);
-      metadata_file.write_raw_bytes(nameval.second.c_str(), nameval.second.size() + 1u);
-    }
-
-    // Write out threadgroup size for compute shader
-    metadata_file.start_new_record();
-    if (maybe_threadgroup_size) {
-      metadata_file.write_field(maybe_threadgroup_size.value()[0]);
-      metadata_file.write_field(maybe_threadgroup_size.value()[1]);
-      metadata_file.write_field(maybe_threadgroup_size.value()[2]);
-    } else {
-      metadata_file.write_field(0u);
-      metadata_file.write_field(0u);
-      metadata_file.write_field(0u);
+    // Write out descriptor bindings to the header file.
+    header_writer.begin_technique(tech.name);
+    for (uint32_t set = 0u; set < res_layout.set_count(); ++set) {
+      for (const descriptor& d : res_layout.set(set)) { header_writer.write_descriptor(d, set); }
     }
-
-    metadata_file.finalize();
+    header_writer.end_technique();
   }
+
+  if (generate_pack) { pack_writer.write(out_folder + PATH_SEPARATOR + pack_path); }
 #pragma endregion gen_output
   return 0;
 }
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "shader-pack-writer.h"
+#include "cli-tool/file-utils.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unordered_map>
+
+void shader_pack_writer::begin_technique(const std::string& name) {
+  techniques_.push_back(technique {name, {}, {}});
+}
+
+void shader_pack_writer::add_shader(uint32_t stage, const std::string& target, std::string code) {
+  assert(!techniques_.empty());
+  techniques_.back().shaders.push_back(shader {stage, target, std::move(code)});
+}
+
+void shader_pack_writer::set_metadata(std::vector<uint8_t> metadata) {
+  assert(!techniques_.empty());
+  techniques_.back().metadata = std::move(metadata);
+}
+
+void shader_pack_writer::write(const std::string& file_path) const {
+  // The technique index is sorted by name hash, so that readers can binary search it.
+  std::vector<std::pair<uint32_t, const technique*>> index;
+  size_t                                             nshaders = 0u;
+  for (const technique& tech : techniques_) {
+    index.emplace_back(ngf_shpk_hash_name(tech.name.c_str()), &tech);
+    nshaders += tech.shaders.size();
+  }
+  std::stable_sort(index.begin(), index.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  });
+
+  // Pool technique names and target names into the string table.
+  std::string                               strings;
+  std::unordered_map<std::string, uint32_t> string_offsets;
+  auto add_string = [&strings, &string_offsets](const std::string& str) {
+    auto [it, inserted] = string_offsets.try_emplace(str, (uint32_t)strings.size());
+    if (inserted) { strings.append(str.c_str(), str.size() + 1u); }
+    return it->second;
+  };
+  for (const technique& tech : techniques_) {
+    add_string(tech.name);
+    for (const shader& s : tech.shaders) { add_string(s.target); }
+  }
+
+  // The header and tables come first, followed by 8-byte aligned blobs.
+  const size_t techniques_offset   = sizeof(ngf_shpk_header);
+  const size_t shaders_offset      = techniques_offset + index.size() * sizeof(ngf_shpk_technique);
+  const size_t string_table_offset = shaders_offset + nshaders * sizeof(ngf_shpk_shader);
+  size_t       blob_offset         = string_table_offset + strings.size();
+  auto         next_blob_offset    = [&blob_offset](size_t size) {
+    blob_offset         = (blob_offset + 7u) & ~(size_t)7u;
+    const size_t offset = blob_offset;
+    blob_offset += size;
+    return offset;
+  };
+
+  std::vector<uint8_t> contents;
+  append_le(contents, NGF_SHPK_MAGIC_NUMBER);
+  append_le(contents, (uint32_t)sizeof(ngf_shpk_header));
+  append_le(contents, NGF_SHPK_VERSION_MAJ);
+  append_le(contents, 0u);
+  append_le(contents, (uint32_t)index.size());
+  append_le(contents, (uint32_t)techniques_offset);
+  append_le(contents, (uint32_t)nshaders);
+  append_le(contents, (uint32_t)shaders_offset);
+  append_le(contents, (uint32_t)string_table_offset);
+  append_le(contents, (uint32_t)strings.size());
+
+  // Blobs are laid out in the order in which they are referenced by the tables: the metadata of
+  // each technique first, then all shaders.
+  uint32_t first_shader = 0u;
+  for (const auto& [name_hash, tech] : index) {
+    append_le(contents, name_hash);
+    append_le(contents, string_offsets[tech->name]);
+    append_le(contents, (uint32_t)next_blob_offset(tech->metadata.size()));
+    append_le(contents, (uint32_t)tech->metadata.size());
+    append_le(contents, first_shader);
+    append_le(contents, (uint32_t)tech->shaders.size());
+    first_shader += (uint32_t)tech->shaders.size();
+  }
+  for (const auto& [name_hash, tech] : index) {
+    for (const shader& s : tech->shaders) {
+      append_le(contents, s.stage);
+      append_le(contents, string_offsets[s.target]);
+      append_le(contents, (uint32_t)next_blob_offset(s.code.size()));
+      append_le(contents, (uint32_t)s.code.size());
+    }
+  }
+  contents.insert(contents.end(), strings.begin(), strings.end());
+  if (blob_offset > UINT32_MAX) {
+    fprintf(stderr, "Shader pack %s exceeds the maximum size of 4 GiB\n", file_path.c_str());
+    exit(1);
+  }
+
+  contents.reserve(blob_offset);
+  auto append_blob = [&contents](const void* data, size_t size) {
+    contents.resize((contents.size() + 7u) & ~(size_t)7u, 0u);
+    contents.insert(contents.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+  };
+  for (const auto& [name_hash, tech] : index) {
+    append_blob(tech->metadata.data(), tech->metadata.size());
+  }
+  for (const auto& [name_hash, tech] : index) {
+    for (const shader& s : tech->shaders) { append_blob(s.code.data(), s.code.size()); }
+  }
+  write_file(file_path, contents.data(), contents.size());
+}
@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "shader-pack/shader-pack.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Convenience class for generating shader packs.
+class shader_pack_writer {
+public:
+  // Begin a new technique. Shaders and metadata added afterwards belong to it.
+  void begin_technique(const std::string& name);
+
+  // Add a shader for the given stage and target (identified by its file extension) to the current
+  // technique.
+  void add_shader(uint32_t stage, const std::string& target, std::string code);
+
+  // Set the pipeline metadata of the current technique.
+  void set_metadata(std::vector<uint8_t> metadata);
+
+  // Write the pack out to the given file.
+  void write(const std::string& file_path) const;
+
+private:
+  struct shader {
+    uint32_t    stage;
+    std::string target;
+    std::string code;
+  };
+  struct technique {
+    std::string          name;
+    std::vector<uint8_t> metadata;
+    std::vector<shader>  shaders;
+  };
+  std::vector<technique> techniques_;
+};
@@ -85,6 +85,13 @@ template<class T> class com_ptr {
     return &ptr_;
   }
 
+  /* Relinquishes ownership of the wrapped pointer without releasing it. */
+  T* detach() {
+    T* ptr = ptr_;
+    ptr_   = nullptr;
+    return ptr;
+  }
+
   private:
   void release() {
     if (ptr_) { ptr_->Release(); }
@@ -28,20 +28,71 @@
 #include "spirv_glsl.hpp"
 #include "spirv_msl.hpp"
 
+#include <new>
+
 namespace niceshade {
 
+namespace {
+
+// Wraps a SPIRV-Cross backend to count how many code generation passes it makes. SPIRV-Cross
+// re-runs code generation from scratch every time force_recompile is requested, and each pass
+// begins by emitting the header.
+template<class CompilerT> class pass_counting_compiler : public CompilerT {
+public:
+  pass_counting_compiler(const uint32_t* spirv_code, size_t word_count)
+      : CompilerT(spirv_code, word_count) {
+  }
+
+  uint32_t* pass_count() noexcept { return &pass_count_; }
+
+protected:
+  void emit_header() override {
+    ++pass_count_;
+    CompilerT::emit_header();
+  }
+
+private:
+  uint32_t pass_count_ = 0u;
+};
+
+// Modules produced with a library target profile contain every entry point of a technique. Makes
+// the compiler operate on the requested one. Modules with a single entry point are left as-is.
+error select_entry_point(
+    spirv_cross::Compiler&             compiler,
+    const technique_desc::entry_point& entry_point) noexcept {
+  try {
+    if (compiler.get_entry_points_and_stages().size() > 1u) {
+      const spv::ExecutionModel execution_model = [&entry_point]() {
+        switch (entry_point.stage) {
+        case pipeline_stage::vertex: return spv::ExecutionModelVertex;
+        case pipeline_stage::fragment: return spv::ExecutionModelFragment;
+        default: return spv::ExecutionModelGLCompute;
+        }
+      }();
+      compiler.set_entry_point(entry_point.name, execution_model);
+    }
+  } catch (spirv_cross::CompilerError& ce) { NICESHADE_RETURN_ERROR(ce.what()); }
+  return error {};
+}
+
+}  // namespace
+
 value_or_error<compilation> compilation::create(
-    pipeline_stage     stage,
-    const spirv_blob&  spirv_code,
-    const target_desc& target_info) noexcept {
+    const technique_desc::entry_point& entry_point,
+    shared_spirv_blob                  spirv_code,
+    const target_desc&                 target_info,
+    string_pool&                       strings) noexcept {
   compilation result;
   result.target_info_    = target_info;
-  result.stage_          = stage;
-  result.original_spirv_ = &spirv_code;
+  result.stage_          = entry_point.stage;
+  result.original_spirv_ = std::move(spirv_code);
+  const const_span<uint32_t>& spirv_words = result.original_spirv_.words;
   switch (result.target_info_.api) {
   case target_api::GL: {
-    auto gl_compiler =
-        std::make_unique<spirv_cross::CompilerGLSL>(spirv_code.data(), spirv_code.size());
+    auto gl_compiler = std::make_unique<pass_counting_compiler<spirv_cross::CompilerGLSL>>(
+        spirv_words.data(),
+        spirv_words.size());
+    NICESHADE_RETURN_IF_ERROR(select_entry_point(*gl_compiler, entry_point));
     spirv_cross::CompilerGLSL::Options opts;
     opts.version                 = target_info.version_maj * 100u + target_info.version_min * 10u;
     opts.separate_shader_objects = true;
@@ -49,17 +100,21 @@ value_or_error<compilation> compilation::create(
     gl_compiler->set_common_options(opts);
     gl_compiler->build_dummy_sampler_for_combined_images();
     gl_compiler->build_combined_image_samplers();
+    result.codegen_pass_count_ = gl_compiler->pass_count();
     result.spv_cross_compiler_ = std::move(gl_compiler);
     break;
   }
   case target_api::VULKAN: {
     result.spv_cross_compiler_ =
-        std::make_unique<spirv_cross::CompilerReflection>(spirv_code.data(), spirv_code.size());
+        std::make_unique<spirv_cross::CompilerReflection>(spirv_words.data(), spirv_words.size());
+    NICESHADE_RETURN_IF_ERROR(select_entry_point(*result.spv_cross_compiler_, entry_point));
     break;
   }
   case target_api::METAL: {
-    auto msl_compiler =
-        std::make_unique<spirv_cross::CompilerMSL>(spirv_code.data(), spirv_code.size());
+    auto msl_compiler = std::make_unique<pass_counting_compiler<spirv_cross::CompilerMSL>>(
+        spirv_words.data(),
+        spirv_words.size());
+    NICESHADE_RETURN_IF_ERROR(select_entry_point(*msl_compiler, entry_point));
     spirv_cross::CompilerMSL::Options opts;
     opts.set_msl_version(target_info.version_maj, target_info.version_min);
     if (target_info.version_min >= 1 && target_info.version_maj >= 2) {
@@ -71,6 +126,7 @@ value_or_error<compilation> compilation::create(
         ios ? spirv_cross::CompilerMSL::Options::iOS : spirv_cross::CompilerMSL::Options::macOS;
     opts.enable_decoration_binding = true;
     msl_compiler->set_msl_options(opts);
+    result.codegen_pass_count_ = msl_compiler->pass_count();
     result.spv_cross_compiler_ = std::move(msl_compiler);
     break;
   }
@@ -118,7 +174,7 @@ value_or_error<compilation> compilation::create(
         get_builtin_name((spv::BuiltIn)compiler->get_decoration(v, spv::DecorationBuiltIn));
     const bool has_location_decoration = compiler->has_decoration(v, spv::DecorationLocation);
     const interface_variable iv {
-        name.empty() ? builtin_name : name,
+        strings.intern(name.empty() ? builtin_name : name),
         t.basetype > interface_variable::TypeCount ? interface_variable::Unknown
                                                    : (interface_variable::type)t.basetype,
         (uint32_t)t.vecsize,
@@ -176,7 +232,13 @@ error compilation::add_resources(pipeline_layout_builder& builder, bool preserve
         .process_resources(resources, dtype, smb, *spv_cross_compiler_, preserve_bindings);
   };
 
-  spirv_cross::ShaderResources resources = spv_cross_compiler_->get_shader_resources();
+  // Modules produced with a library target profile contain the resources of every entry point, so
+  // only the ones used by the selected entry point are attributed to this stage.
+  const bool shared_module = spv_cross_compiler_->get_entry_points_and_stages().size() > 1u;
+  spirv_cross::ShaderResources resources =
+      shared_module ? spv_cross_compiler_->get_shader_resources(
+                          spv_cross_compiler_->get_active_interface_variables())
+                    : spv_cross_compiler_->get_shader_resources();
 
   NICESHADE_RETURN_IF_ERROR(
       process_resources(resources.uniform_buffers, descriptor_type::UNIFORM_BUFFER));
@@ -197,21 +259,29 @@ error compilation::add_resources(pipeline_layout_builder& builder, bool preserve
 
 std::optional<std::array<uint32_t, 3>> compilation::threadgroup_size() const noexcept {
   if (stage_ == pipeline_stage::compute) {
-    spirv_cross::SmallVector<spirv_cross::EntryPoint> eps =
-        spv_cross_compiler_->get_entry_points_and_stages();
-    const auto& tgsize =
-        spv_cross_compiler_->get_entry_point(eps[0].name, eps[0].execution_model).workgroup_size;
-    return std::array<uint32_t, 3> {tgsize.x, tgsize.y, tgsize.z};
+    // Queries the entry point selected at creation time.
+    const spirv_cross::Compiler& compiler = *spv_cross_compiler_;
+    return std::array<uint32_t, 3> {
+        compiler.get_execution_mode_argument(spv::ExecutionModeLocalSize, 0u),
+        compiler.get_execution_mode_argument(spv::ExecutionModeLocalSize, 1u),
+        compiler.get_execution_mode_argument(spv::ExecutionModeLocalSize, 2u)};
   } else {
     return std::nullopt;
   }
 }
+
+uint32_t compilation::codegen_passes() const noexcept {
+  return codegen_pass_count_ ? *codegen_pass_count_ : 0u;
+}
+
 value_or_error<compilation_result> compilation::run(const pipeline_layout& layout) noexcept {
   try {
     return (target_info_.api != target_api::VULKAN)
                ? compilation_result {spv_cross_compiler_->compile()}
-               : compilation_result {*original_spirv_};
-  } catch (spirv_cross::CompilerError& ce) { NICESHADE_RETURN_ERROR(ce.what()); }
+               : compilation_result {original_spirv_};
+  } catch (spirv_cross::CompilerError& ce) {
+    NICESHADE_RETURN_ERROR(ce.what());
+  } catch (std::bad_alloc&) { NICESHADE_RETURN_ERROR("out of memory while generating code"); }
 }
 
 }  // namespace niceshade
@@ -32,7 +32,9 @@
 #include "libniceshade/common-types.h"
 #include "libniceshade/output.h"
 #include "libniceshade/spec-const-layout.h"
+#include "libniceshade/string-pool.h"
 #include "libniceshade/target.h"
+#include "libniceshade/technique.h"
 #include "spirv_cross.hpp"
 
 #include <array>
@@ -47,9 +49,10 @@ namespace niceshade {
 class compilation {
 public:
   static value_or_error<compilation> create(
-      pipeline_stage     kind,
-      const spirv_blob&  spirv_code,
-      const target_desc& target_info) noexcept;
+      const technique_desc::entry_point& entry_point,
+      shared_spirv_blob                  spirv_code,
+      const target_desc&                 target_info,
+      string_pool&                       strings) noexcept;
 
   error add_resources(pipeline_layout_builder& builder, bool preserve_bindings) const noexcept;
   error add_spec_consts(spec_const_layout_builder& builder) const noexcept;
@@ -59,9 +62,16 @@ public:
 
   value_or_error<compilation_result> run(const pipeline_layout& pipeline_layout) noexcept;
 
+  // Makes SPIR-V targets output the given module instead of the one the compilation was created
+  // with. Reflection data is not affected.
+  void set_output_spirv(shared_spirv_blob spirv_code) noexcept {
+    original_spirv_ = std::move(spirv_code);
+  }
+
   pipeline_stage                         stage() const noexcept { return stage_; }
   const target_desc&                     target() const noexcept { return target_info_; }
   std::optional<std::array<uint32_t, 3>> threadgroup_size() const noexcept;
+  uint32_t                               codegen_passes() const noexcept;
   const std::vector<interface_variable>& input_vars() const noexcept { return input_vars_; }
   const std::vector<interface_variable>& output_vars() const noexcept { return output_vars_; }
 
@@ -69,7 +79,8 @@ private:
   target_desc                            target_info_;
   pipeline_stage                         stage_;
   std::unique_ptr<spirv_cross::Compiler> spv_cross_compiler_;
-  const spirv_blob*                      original_spirv_ = nullptr;
+  shared_spirv_blob                      original_spirv_;
+  const uint32_t*                        codegen_pass_count_ = nullptr;  // Owned by the compiler.
   std::vector<interface_variable>        input_vars_;
   std::vector<interface_variable>        output_vars_;
 };
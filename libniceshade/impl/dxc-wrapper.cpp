@@ -26,6 +26,7 @@
 #include "impl/dxc-wrapper.h"
 
 #include "impl/error-macros.h"
+#include "impl/include-handler.h"
 
 #include <stdlib.h>
 #include <string>
@@ -64,10 +65,11 @@ value_or_error<dxc_wrapper> dxc_wrapper::create(
     const std::string& sm,
     span<std::string>  dxc_params,
     const std::string& exe_dir,
-    hlsl_diagnostic_callback diag_callback) noexcept {
+    hlsl_diagnostic_callback diag_callback,
+    hlsl_include_resolver    include_resolver) noexcept {
   dxc_wrapper result;
   result.shader_model_   = towstring(sm.c_str(), sm.length());
-  result.dxcompiler_dll_ = get_dxc_lib_path_candidates(exe_dir);
+  result.dxcompiler_dll_ = std::make_shared<dynamic_lib>(get_dxc_lib_path_candidates(exe_dir));
   result.dxc_params_.emplace_back(L"-spirv");  // always enable spir-v codegen.
   // Convert dxc parameters to wide string.
   for (const std::string& dxc_param : dxc_params) {
@@ -77,14 +79,14 @@ value_or_error<dxc_wrapper> dxc_wrapper::create(
   }
 
   // Verify that the dymamic library could be loaded.
-  if (result.dxcompiler_dll_.is_valid()) {
+  if (result.dxcompiler_dll_->is_valid()) {
     fprintf(stderr, "dxcompiler library not loaded (exe dir was \"%s\").\n", exe_dir.c_str());
     exit(1);
   }
 
   // Look up the function for creating an instance of the library.
   auto create_proc =
-      (DxcCreateInstanceProc)result.dxcompiler_dll_.get_proc_address("DxcCreateInstance");
+      (DxcCreateInstanceProc)result.dxcompiler_dll_->get_proc_address("DxcCreateInstance");
   if (nullptr == create_proc) { NICESHADE_RETURN_ERROR("failed to load DxcCreateInstance"); }
 
   // Instantiate library, compiler and include handler.
@@ -95,8 +97,14 @@ value_or_error<dxc_wrapper> dxc_wrapper::create(
     return create_proc(CLSID_DxcCompiler, __uuidof(IDxcCompiler), (LPVOID*)ptr);
   });
 
-  result.include_handler_ = com_ptr<IDxcIncludeHandler>(
+  // Includes are served from the resolver if there is one, and otherwise loaded through the
+  // default handler. Files loaded from disk are cached for the lifetime of the wrapper.
+  auto default_include_handler = com_ptr<IDxcIncludeHandler>(
       [&](auto ptr) { return result.library_instance_->CreateIncludeHandler(ptr); });
+  result.include_handler_ = com_ptr<include_handler>(new include_handler(
+      result.library_instance_.get(),
+      std::move(default_include_handler),
+      std::move(include_resolver)));
 
   result.diag_callback_ = diag_callback;
 
@@ -107,20 +115,63 @@ dxc_wrapper::~dxc_wrapper() noexcept {
   for (size_t i = 1u; i < dxc_params_.size(); ++i) delete[] dxc_params_[i];
 }
 
-value_or_error<spirv_blob> dxc_wrapper::compile_hlsl2spv(
+value_or_error<shared_spirv_blob> dxc_wrapper::compile_hlsl2spv(
     const char*                        source,
     size_t                             source_size,
     const char*                        input_file_name,
     const technique_desc::entry_point& entry_point,
+    const define_container*            shared_defines,
     const define_container&            defines) noexcept {
+  const std::wstring target_profile = [&entry_point]() {
+    switch (entry_point.stage) {
+    case pipeline_stage::vertex: return L"vs_";
+    case pipeline_stage::fragment: return L"ps_";
+    case pipeline_stage::compute: return L"cs_";
+    default: exit(1);
+    }
+  }() + shader_model_;
+  return invoke_dxc(
+      source,
+      source_size,
+      input_file_name,
+      towstring(entry_point.name.c_str(), entry_point.name.size()),
+      target_profile,
+      shared_defines,
+      defines);
+}
+
+value_or_error<shared_spirv_blob> dxc_wrapper::compile_hlsl2spv_library(
+    const char*             source,
+    size_t                  source_size,
+    const char*             input_file_name,
+    const define_container* shared_defines,
+    const define_container& defines) noexcept {
+  // Library targets export every function marked with a [shader("...")] attribute as an entry
+  // point, so no entry point name is passed.
+  return invoke_dxc(
+      source,
+      source_size,
+      input_file_name,
+      std::wstring {},
+      L"lib_" + shader_model_,
+      shared_defines,
+      defines);
+}
+
+value_or_error<shared_spirv_blob> dxc_wrapper::invoke_dxc(
+    const char*             source,
+    size_t                  source_size,
+    const char*             input_file_name,
+    const std::wstring&     wentry_point_name,
+    const std::wstring&     target_profile,
+    const define_container* shared_defines,
+    const define_container& defines) noexcept {
   auto input_blob = com_ptr<IDxcBlobEncoding>([&](auto ptr) {
     return library_instance_
         ->CreateBlobWithEncodingFromPinned(source, (uint32_t)source_size, 0, ptr);
   });
 
   const std::wstring winput_file_name = towstring(input_file_name, strlen(input_file_name));
-  const std::wstring wentry_point_name =
-      towstring(entry_point.name.c_str(), entry_point.name.size());
 
   // This vector contains the wide-string versions of the defines.
   std::vector<std::pair<std::wstring, std::wstring>> wdefines;
@@ -129,26 +180,24 @@ value_or_error<spirv_blob> dxc_wrapper::compile_hlsl2spv(
   // the preceding `wdefines` vector. Those actually get fed to the dxc compiler.
   std::vector<DxcDefine> dxc_defines;
 
-  wdefines.reserve(defines.size());
-  dxc_defines.reserve(defines.size());
-  for (const std::pair<std::string, std::string>& define : defines) {
-    wdefines.emplace_back(
-        towstring(define.first.c_str(), define.first.size()),
-        towstring(define.second.c_str(), define.second.size()));
-    const auto& wdefine = wdefines.back();
-    dxc_defines.emplace_back(DxcDefine {
-        wdefine.first.c_str(),
-        wdefine.second.empty() ? nullptr : wdefine.second.c_str()});
-  }
-
-  const std::wstring target_profile = [&entry_point]() {
-    switch (entry_point.stage) {
-    case pipeline_stage::vertex: return L"vs_";
-    case pipeline_stage::fragment: return L"ps_";
-    case pipeline_stage::compute: return L"cs_";
-    default: exit(1);
+  // Shared definitions go first, followed by the technique-specific ones.
+  const size_t define_count = defines.size() + (shared_defines ? shared_defines->size() : 0u);
+  wdefines.reserve(define_count);
+  dxc_defines.reserve(define_count);
+  auto add_defines = [&](const define_container& defs) {
+    for (const std::pair<std::string, std::string>& define : defs) {
+      wdefines.emplace_back(
+          towstring(define.first.c_str(), define.first.size()),
+          towstring(define.second.c_str(), define.second.size()));
+      const auto& wdefine = wdefines.back();
+      dxc_defines.emplace_back(DxcDefine {
+          wdefine.first.c_str(),
+          wdefine.second.empty() ? nullptr : wdefine.second.c_str()});
     }
-  }() + shader_model_;
+  };
+  if (shared_defines) { add_defines(*shared_defines); }
+  add_defines(defines);
+
   auto dxc_result = com_ptr<IDxcOperationResult>([&, this](auto ptr) {
     return compiler_instance_->Compile(
         input_blob.get(),
@@ -172,11 +221,15 @@ value_or_error<spirv_blob> dxc_wrapper::compile_hlsl2spv(
   }
 
   if (dxc_spirv_blob.get() != nullptr && dxc_spirv_blob->GetBufferSize() > 0) {
-    const uint32_t* dxc_blob_start =
-        reinterpret_cast<uint32_t*>(dxc_spirv_blob->GetBufferPointer());
-    const uint32_t* dxc_blob_end =
-        dxc_blob_start + dxc_spirv_blob->GetBufferSize() / sizeof(uint32_t);
-    return spirv_blob(dxc_blob_start, dxc_blob_end);
+    // Adopt the blob instead of copying its contents. The blob's memory is owned by the DXC
+    // library, so the library must stay loaded for as long as the blob is alive.
+    IDxcBlob*                  blob = dxc_spirv_blob.detach();
+    const const_span<uint32_t> words {
+        reinterpret_cast<const uint32_t*>(blob->GetBufferPointer()),
+        blob->GetBufferSize() / sizeof(uint32_t)};
+    return shared_spirv_blob {
+        words,
+        std::shared_ptr<const void>(blob, [dll = dxcompiler_dll_](IDxcBlob* b) { b->Release(); })};
   } else {
     NICESHADE_RETURN_ERROR("failed to compile HLSL to SPIR-V");
   }
@@ -26,12 +26,14 @@
 
 #include "impl/com-ptr.h"
 #include "impl/dynamic-library.h"
+#include "impl/include-handler.h"
 #include "impl/platform.h"
 #include "impl/technique-parser.h"
 #include "libniceshade/common-types.h"
 #include "libniceshade/error.h"
 #include "libniceshade/span.h"
 
+#include <memory>
 #include <stdint.h>
 #include <string>
 #include <vector>
@@ -53,7 +55,8 @@ public:
       const std::string&       sm,
       span<std::string>        dxc_params,
       const std::string&       exe_dir,
-      hlsl_diagnostic_callback diag_callback) noexcept;
+      hlsl_diagnostic_callback diag_callback,
+      hlsl_include_resolver    include_resolver) noexcept;
 
   dxc_wrapper() noexcept = default;
   dxc_wrapper(dxc_wrapper&&) noexcept = default;
@@ -61,21 +64,42 @@ public:
 
   dxc_wrapper& operator=(dxc_wrapper&&) = default;
 
-  value_or_error<spirv_blob> compile_hlsl2spv(
+  value_or_error<shared_spirv_blob> compile_hlsl2spv(
       const char*                        source,
       size_t                             source_size,
       const char*                        input_file_name,
       const technique_desc::entry_point& entry_point,
+      const define_container*            shared_defines,
       const define_container&            defines) noexcept;
 
+  // Compiles all entry points marked with a [shader("...")] attribute into a single SPIR-V module
+  // using a library target profile.
+  value_or_error<shared_spirv_blob> compile_hlsl2spv_library(
+      const char*             source,
+      size_t                  source_size,
+      const char*             input_file_name,
+      const define_container* shared_defines,
+      const define_container& defines) noexcept;
+
+  const include_stats& include_statistics() const noexcept { return include_handler_->stats(); }
+
 private:
-  std::wstring                shader_model_;
-  dynamic_lib                 dxcompiler_dll_;
-  com_ptr<IDxcLibrary>        library_instance_;
-  com_ptr<IDxcCompiler>       compiler_instance_;
-  com_ptr<IDxcIncludeHandler> include_handler_;
-  std::vector<LPCWSTR>        dxc_params_;
-  hlsl_diagnostic_callback    diag_callback_ = nullptr;
+  value_or_error<shared_spirv_blob> invoke_dxc(
+      const char*             source,
+      size_t                  source_size,
+      const char*             input_file_name,
+      const std::wstring&     wentry_point_name,
+      const std::wstring&     target_profile,
+      const define_container* shared_defines,
+      const define_container& defines) noexcept;
+
+  std::wstring                 shader_model_;
+  std::shared_ptr<dynamic_lib> dxcompiler_dll_;  // Shared with blobs handed out by DXC.
+  com_ptr<IDxcLibrary>         library_instance_;
+  com_ptr<IDxcCompiler>        compiler_instance_;
+  com_ptr<include_handler>     include_handler_;
+  std::vector<LPCWSTR>         dxc_params_;
+  hlsl_diagnostic_callback     diag_callback_ = nullptr;
 };
 
 }  // namespace niceshade
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "impl/include-handler.h"
+
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <wchar.h>
+
+namespace niceshade {
+
+namespace {
+
+// Converts a path received from DXC into a multibyte string. Returns false if the conversion fails.
+bool narrow_path(LPCWSTR wide_path, std::string& path) noexcept {
+  path.assign(wcslen(wide_path) * MB_CUR_MAX + 1u, '\0');
+  const size_t path_length = std::wcstombs(path.data(), wide_path, path.size());
+  if (path_length == (size_t)-1) { return false; }
+  path.resize(path_length);
+  return true;
+}
+
+// Looks up the modification time and size of a file. Returns false if the file can't be examined.
+bool get_file_stats(
+    LPCWSTR            wide_path,
+    const std::string& path,
+    int64_t&           modification_time,
+    int64_t&           size) noexcept {
+#if defined(_WIN32) || defined(_WIN64)
+  (void)path;
+  struct _stat64 statbuf;
+  if (_wstat64(wide_path, &statbuf) != 0) { return false; }
+  modification_time = (int64_t)statbuf.st_mtime;
+#else
+  (void)wide_path;
+  struct stat statbuf;
+  if (stat(path.c_str(), &statbuf) != 0) { return false; }
+#if defined(__APPLE__)
+  modification_time =
+      (int64_t)statbuf.st_mtimespec.tv_sec * 1000000000 + statbuf.st_mtimespec.tv_nsec;
+#else
+  modification_time = (int64_t)statbuf.st_mtim.tv_sec * 1000000000 + statbuf.st_mtim.tv_nsec;
+#endif
+#endif
+  size = (int64_t)statbuf.st_size;
+  return true;
+}
+
+}  // namespace
+
+include_handler::include_handler(
+    IDxcLibrary*                  library,
+    com_ptr<IDxcIncludeHandler>&& default_handler,
+    hlsl_include_resolver         resolver) noexcept
+    : library_ {library},
+      default_handler_ {std::move(default_handler)},
+      resolver_ {std::move(resolver)} {
+  library->AddRef();
+}
+
+HRESULT include_handler::LoadSource(LPCWSTR filename, IDxcBlob** include_source) {
+  if (include_source == nullptr) { return E_INVALIDARG; }
+  *include_source = nullptr;
+  std::string path;
+  const bool  have_path = narrow_path(filename, path);
+  if (resolver_ && have_path) {
+    input_blob contents;
+    if (resolver_(path.c_str(), contents)) {
+      // Pinned blobs refer to the resolver's memory directly instead of copying it.
+      IDxcBlobEncoding* blob = nullptr;
+      const HRESULT     hr   = library_->CreateBlobWithEncodingFromPinned(
+          contents.data(),
+          (uint32_t)contents.size(),
+          0,
+          &blob);
+      *include_source = blob;
+      ++stats_.resolved;
+      return hr;
+    }
+  }
+
+  // Files that can't be examined are left entirely to the default handler, which also takes care
+  // of reporting missing files.
+  int64_t modification_time = 0, size = 0;
+  if (!have_path || !get_file_stats(filename, path, modification_time, size)) {
+    return default_handler_->LoadSource(filename, include_source);
+  }
+  cached_file& cached = cache_[filename];
+  if (cached.blob.get() == nullptr || cached.modification_time != modification_time ||
+      cached.size != size) {
+    IDxcBlob*     blob = nullptr;
+    const HRESULT hr   = default_handler_->LoadSource(filename, &blob);
+    if (hr != S_OK || blob == nullptr) {
+      cache_.erase(filename);
+      *include_source = blob;
+      return hr;
+    }
+    cached.blob              = com_ptr<IDxcBlob>(blob);
+    cached.modification_time = modification_time;
+    cached.size              = size;
+    ++stats_.loaded;
+  } else {
+    ++stats_.cache_hits;
+  }
+  cached.blob->AddRef();
+  *include_source = cached.blob.get();
+  return S_OK;
+}
+
+HRESULT include_handler::QueryInterface(REFIID riid, void** object) {
+  if (object == nullptr) { return E_POINTER; }
+  if (IsEqualIID(riid, __uuidof(IDxcIncludeHandler)) || IsEqualIID(riid, __uuidof(IUnknown))) {
+    AddRef();
+    *object = static_cast<IDxcIncludeHandler*>(this);
+    return S_OK;
+  }
+  *object = nullptr;
+  return E_NOINTERFACE;
+}
+
+ULONG include_handler::AddRef() {
+  return ++ref_count_;
+}
+
+ULONG include_handler::Release() {
+  const ULONG ref_count = --ref_count_;
+  if (ref_count == 0u) { delete this; }
+  return ref_count;
+}
+
+}  // namespace niceshade
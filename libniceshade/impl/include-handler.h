@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "impl/com-ptr.h"
+#include "impl/platform.h"
+#include "libniceshade/common-types.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+namespace niceshade {
+
+/**
+ * Handles HLSL `#include` directives. Files are first requested from a user-supplied resolver (if
+ * any) and served from memory without copying; files that the resolver doesn't provide are loaded
+ * from the filesystem by DXC's default include handler.
+ *
+ * Files loaded from the filesystem are cached, so that a header included by many entry points and
+ * techniques is only read and decoded once. A cached file is reloaded if its modification time or
+ * size change.
+ */
+class include_handler final : public IDxcIncludeHandler {
+public:
+  include_handler(
+      IDxcLibrary*                  library,
+      com_ptr<IDxcIncludeHandler>&& default_handler,
+      hlsl_include_resolver         resolver) noexcept;
+
+  HRESULT STDMETHODCALLTYPE LoadSource(LPCWSTR filename, IDxcBlob** include_source) override;
+
+  const include_stats& stats() const noexcept { return stats_; }
+
+  HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override;
+  ULONG STDMETHODCALLTYPE   AddRef() override;
+  ULONG STDMETHODCALLTYPE   Release() override;
+
+private:
+  struct cached_file {
+    com_ptr<IDxcBlob> blob;
+    int64_t           modification_time = 0;
+    int64_t           size              = 0;
+  };
+
+  ~include_handler() noexcept = default;
+
+  std::atomic<ULONG>                            ref_count_ {1u};
+  com_ptr<IDxcLibrary>                          library_;
+  com_ptr<IDxcIncludeHandler>                   default_handler_;
+  hlsl_include_resolver                         resolver_;
+  std::unordered_map<std::wstring, cached_file> cache_;
+  include_stats                                 stats_;
+};
+
+}  // namespace niceshade
@@ -25,12 +25,29 @@
 #include "impl/compilation.h"
 #include "impl/dxc-wrapper.h"
 #include "impl/error-macros.h"
+#include "impl/mapped-file.h"
 #include "impl/pipeline-layout-builder.h"
 #include "impl/separate-to-combined-builder.h"
+#include "impl/spirv-stripper.h"
 #include "impl/technique-parser.h"
 
+#include <sstream>
+
 namespace niceshade {
 
+namespace {
+
+const char* stage_name(pipeline_stage stage) noexcept {
+  switch (stage) {
+  case pipeline_stage::vertex: return "vertex";
+  case pipeline_stage::fragment: return "fragment";
+  case pipeline_stage::compute: return "compute";
+  }
+  return "unknown";
+}
+
+}  // namespace
+
 value_or_error<instance> instance::create(const instance::options& opts) noexcept {
   instance                 result;
   std::vector<std::string> dxc_params_copy;
@@ -45,9 +62,15 @@ value_or_error<instance> instance::create(const instance::options& opts) noexcep
           opts.preserve_bindings ? span<std::string>(dxc_params_copy.data(), dxc_params_copy.size())
                                  : opts.dxc_params,
           opts.dxc_lib_folder,
-          opts.diagnostic_message_callback));
-  result.dxc_               = new dxc_wrapper {std::move(dxc)};
-  result.preserve_bindings_ = opts.preserve_bindings;
+          opts.diagnostic_message_callback,
+          opts.include_resolver));
+  result.dxc_                             = new dxc_wrapper {std::move(dxc)};
+  result.preserve_bindings_               = opts.preserve_bindings;
+  result.diag_callback_                   = opts.diagnostic_message_callback;
+  result.codegen_pass_warning_threshold_  = opts.codegen_pass_warning_threshold;
+  result.compile_techniques_as_libraries_ = opts.compile_techniques_as_libraries;
+  result.reflection_only_                 = opts.reflection_only;
+  result.strip_debug_info_                = opts.strip_debug_info;
   return result;
 }
 
@@ -55,60 +78,96 @@ instance::~instance() noexcept {
   if (dxc_) delete dxc_;
 }
 
-value_or_error<compiled_techniques>
-instance::compile(const_span<compiler_input> inputs, const_span<target_desc> targets) noexcept {
-  compiled_techniques result;
+value_or_error<compiled_techniques> instance::compile(
+    const_span<compiler_input> inputs,
+    const_span<target_desc>    targets,
+    std::pmr::memory_resource* resource) noexcept {
+  compiled_techniques result {resource};
+  // Names referenced by the results are interned here, so that each one is stored only once no
+  // matter how many techniques and targets use it.
+  auto strings = std::allocate_shared<string_pool>(arena_allocator<string_pool> {resource}, resource);
   for (const auto& input : inputs) {
     const const_span<technique_desc>& techniques = input.technique_descs;
 
     for (const technique_desc& tech : techniques) {
-      std::vector<spirv_blob> spirv_blobs;
+      std::pmr::vector<shared_spirv_blob> spirv_blobs {resource};
       // Produce SPIR-V.
-      for (const technique_desc::entry_point& ep : tech.entry_points) {
+      if (compile_techniques_as_libraries_ && tech.entry_points.size() > 1u) {
+        // A single DXC invocation produces one module containing all of the technique's entry
+        // points, which is then shared by all of its stages.
         NICESHADE_DECLARE_OR_RETURN(
-            spirv_blob,
-            dxc_->compile_hlsl2spv(
+            spirv_code,
+            dxc_->compile_hlsl2spv_library(
                 (const char*)input.hlsl.cbegin(),
                 input.hlsl.size(),
                 input.file_name,
-                ep,
+                tech.shared_defines.get(),
                 tech.defines));
-        if (spirv_blob.size() == 0) { NICESHADE_RETURN_ERROR("no SPIR-V generated"); }
-        spirv_blobs.emplace_back(std::move(spirv_blob));
+        if (spirv_code.words.size() == 0) { NICESHADE_RETURN_ERROR("no SPIR-V generated"); }
+        spirv_blobs.assign(tech.entry_points.size(), spirv_code);
+      } else {
+        for (const technique_desc::entry_point& ep : tech.entry_points) {
+          NICESHADE_DECLARE_OR_RETURN(
+              spirv_code,
+              dxc_->compile_hlsl2spv(
+                  (const char*)input.hlsl.cbegin(),
+                  input.hlsl.size(),
+                  input.file_name,
+                  ep,
+                  tech.shared_defines.get(),
+                  tech.defines));
+          if (spirv_code.words.size() == 0) { NICESHADE_RETURN_ERROR("no SPIR-V generated"); }
+          spirv_blobs.emplace_back(std::move(spirv_code));
+        }
       }
 
       // Create compilations and populate the pipeline layout.
-      pipeline_layout_builder          res_layout_builder;
-      spec_const_layout_builder        spec_const_builder;
-      separate_to_combined_builder     image_map_builder;
-      separate_to_combined_builder     sampler_map_builder;
-      std::vector<interface_variables> interface_vars;
-      std::vector<compilation>         compilations;
-      bool                             first_target = true;
+      pipeline_layout_builder           res_layout_builder {*strings, resource};
+      spec_const_layout_builder         spec_const_builder {*strings, resource};
+      separate_to_combined_builder      image_map_builder {resource};
+      separate_to_combined_builder      sampler_map_builder {resource};
+      arena_vector<interface_variables> interface_vars {resource};
+      std::pmr::vector<compilation>     compilations {resource};
+      bool                              first_target = true;
       for (const target_desc& target_info : targets) {
         for (const technique_desc::entry_point& ep : tech.entry_points) {
           const intptr_t ep_idx = &ep - tech.entry_points.data();
           NICESHADE_DECLARE_OR_RETURN(
               new_compilation,
-              compilation::create(ep.stage, spirv_blobs[ep_idx], target_info));
+              compilation::create(ep, spirv_blobs[ep_idx], target_info, *strings));
           compilations.emplace_back(std::move(new_compilation));
           NICESHADE_RETURN_IF_ERROR(
               compilations.back().add_resources(res_layout_builder, preserve_bindings_));
           NICESHADE_RETURN_IF_ERROR(compilations.back().add_spec_consts(spec_const_builder));
           compilations.back().add_cis_to_map(image_map_builder, sampler_map_builder);
           if (first_target) {
+            const auto& input_vars  = compilations.back().input_vars();
+            const auto& output_vars = compilations.back().output_vars();
             interface_vars.emplace_back(interface_variables {
                 ep.stage,
-                compilations.back().input_vars(),
-                compilations.back().output_vars()});
+                {input_vars.begin(), input_vars.end(), resource},
+                {output_vars.begin(), output_vars.end(), resource}});
           }
         }
         first_target = false;
       }
       NICESHADE_DECLARE_OR_RETURN(res_layout, res_layout_builder.build());
 
+      // Reflection is done at this point, so SPIR-V output no longer needs debug instructions.
+      // Stages that share a module also share its stripped version.
+      std::pmr::vector<shared_spirv_blob> stripped_blobs {resource};
+      if (strip_debug_info_ && !reflection_only_) {
+        for (size_t i = 0u; i < spirv_blobs.size(); ++i) {
+          if (i > 0u && spirv_blobs[i].words.data() == spirv_blobs[i - 1u].words.data()) {
+            stripped_blobs.push_back(stripped_blobs.back());
+          } else {
+            stripped_blobs.push_back(strip_debug_instructions(spirv_blobs[i]));
+          }
+        }
+      }
+
       // Create a new compiled technique.
-      result.emplace_back();
+      result.emplace_back(resource);
       compiled_technique& compiled_tech = result.back();
       compiled_tech.name                = tech.name;
       compiled_tech.layout              = std::move(res_layout);
@@ -116,20 +175,40 @@ instance::compile(const_span<compiler_input> inputs, const_span<target_desc> tar
       compiled_tech.image_map           = std::move(image_map_builder.build());
       compiled_tech.sampler_map         = std::move(sampler_map_builder.build());
       compiled_tech.per_stage_interface = std::move(interface_vars);
+      compiled_tech.strings             = strings;
 
       // Run all compilations.
       for (compilation& c : compilations) {
         if (compiled_tech.targeted_outputs.empty() ||
             compiled_tech.targeted_outputs.back().target != c.target()) {
-          compiled_tech.targeted_outputs.emplace_back();
+          compiled_tech.targeted_outputs.emplace_back(resource);
           compiled_tech.targeted_outputs.back().target = c.target();
         }
         targeted_output& target_out = compiled_tech.targeted_outputs.back();
-        NICESHADE_DECLARE_OR_RETURN(compilation_result, c.run(compiled_tech.layout));
         target_out.stages.emplace_back();
-        target_out.stages.back().result           = std::move(compilation_result);
         target_out.stages.back().stage            = c.stage();
         target_out.stages.back().threadgroup_size = c.threadgroup_size();
+        if (reflection_only_) { continue; }
+        const size_t ep_idx = (size_t)(&c - compilations.data()) % tech.entry_points.size();
+        if (!stripped_blobs.empty() && c.target().api == target_api::VULKAN) {
+          target_out.stages.back().stats.stripped_debug_bytes = (uint32_t)(
+              (spirv_blobs[ep_idx].words.size() - stripped_blobs[ep_idx].words.size()) *
+              sizeof(uint32_t));
+          c.set_output_spirv(stripped_blobs[ep_idx]);
+        }
+        NICESHADE_DECLARE_OR_RETURN(compilation_result, c.run(compiled_tech.layout));
+        target_out.stages.back().result               = std::move(compilation_result);
+        target_out.stages.back().stats.codegen_passes = c.codegen_passes();
+        if (codegen_pass_warning_threshold_ > 0u && diag_callback_ &&
+            c.codegen_passes() > codegen_pass_warning_threshold_) {
+          std::ostringstream os;
+          os << "warning: " << stage_name(c.stage()) << " stage of technique " << tech.name
+             << " took " << c.codegen_passes() << " code generation passes for target "
+             << file_ext_for_target(c.target()) << " (threshold is "
+             << codegen_pass_warning_threshold_ << ")\n";
+          const std::string msg = os.str();
+          diag_callback_(msg.c_str(), msg.size());
+        }
       }
     }
   }
@@ -137,10 +216,11 @@ instance::compile(const_span<compiler_input> inputs, const_span<target_desc> tar
 }
 
 value_or_error<descs_and_compiled_techniques> instance::parse_techniques_and_compile(
-    input_blob              in_blob,
-    const char*             file_name,
-    const_span<target_desc> targets,
-    const define_container& global_defines) noexcept {
+    input_blob                 in_blob,
+    const char*                file_name,
+    const_span<target_desc>    targets,
+    const define_container&    global_defines,
+    std::pmr::memory_resource* resource) noexcept {
   NICESHADE_DECLARE_OR_RETURN(parsed_techniques, parse_techniques(in_blob, global_defines));
   if (parsed_techniques.size() == 0) {
     NICESHADE_RETURN_ERROR("The input file does not appear to define any techniques. "
@@ -154,9 +234,27 @@ value_or_error<descs_and_compiled_techniques> instance::parse_techniques_and_com
   input.hlsl      = in_blob;
   NICESHADE_DECLARE_OR_RETURN(
       compd_techniques,
-      compile(const_span<compiler_input> {&input, 1u}, targets));
+      compile(const_span<compiler_input> {&input, 1u}, targets, resource));
   assert(compd_techniques.size() == parsed_techniques.size());
   return std::make_tuple(std::move(parsed_techniques), std::move(compd_techniques));
 }
 
+value_or_error<descs_and_compiled_techniques> instance::parse_techniques_and_compile_file(
+    const char*                file_path,
+    const_span<target_desc>    targets,
+    const define_container&    global_defines,
+    std::pmr::memory_resource* resource) noexcept {
+  NICESHADE_DECLARE_OR_RETURN(input_file, mapped_file::create(file_path));
+  return parse_techniques_and_compile(
+      input_file.blob(),
+      file_path,
+      targets,
+      global_defines,
+      resource);
+}
+
+include_stats instance::include_statistics() const noexcept {
+  return dxc_ ? dxc_->include_statistics() : include_stats {};
+}
+
 }  // namespace niceshade
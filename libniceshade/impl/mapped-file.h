@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "impl/error-macros.h"
+#include "impl/platform.h"
+#include "libniceshade/common-types.h"
+#include "libniceshade/error.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace niceshade {
+
+/**
+ * A read-only view of a file's contents, mapped into memory. The view remains valid for as long as
+ * the object is alive. Empty files are represented by an empty blob and are not mapped.
+ */
+class mapped_file {
+public:
+  mapped_file() = default;
+
+  static value_or_error<mapped_file> create(const char* path) noexcept {
+    mapped_file result;
+#if defined(_WIN32) || defined(_WIN64)
+    const HANDLE file = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) { NICESHADE_RETURN_ERROR("Failed to open file ", path); }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+      CloseHandle(file);
+      NICESHADE_RETURN_ERROR("Failed to read file ", path);
+    }
+    if (file_size.QuadPart > 0) {
+      const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      CloseHandle(file);
+      if (mapping == nullptr) { NICESHADE_RETURN_ERROR("Failed to read file ", path); }
+      result.data_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+      if (result.data_ == nullptr) { NICESHADE_RETURN_ERROR("Failed to read file ", path); }
+      result.size_ = (size_t)file_size.QuadPart;
+    } else {
+      CloseHandle(file);
+    }
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) { NICESHADE_RETURN_ERROR("Failed to open file ", path); }
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) != 0) {
+      close(fd);
+      NICESHADE_RETURN_ERROR("Failed to read file ", path);
+    }
+    if (statbuf.st_size > 0) {
+      void* data = mmap(nullptr, (size_t)statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (data == MAP_FAILED) { NICESHADE_RETURN_ERROR("Failed to read file ", path); }
+      // The input is consumed front to back.
+      madvise(data, (size_t)statbuf.st_size, MADV_SEQUENTIAL);
+      result.data_ = data;
+      result.size_ = (size_t)statbuf.st_size;
+    } else {
+      close(fd);
+    }
+#endif
+    return result;
+  }
+
+  ~mapped_file() noexcept {
+    if (data_ == nullptr) { return; }
+#if defined(_WIN32) || defined(_WIN64)
+    UnmapViewOfFile(data_);
+#else
+    munmap(data_, size_);
+#endif
+  }
+
+  mapped_file(const mapped_file&)            = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+  mapped_file(mapped_file&& other) noexcept { *this = std::move(other); }
+  mapped_file& operator=(mapped_file&& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  input_blob blob() const noexcept { return input_blob {(const std::byte*)data_, size_}; }
+
+private:
+  void*  data_ = nullptr;
+  size_t size_ = 0u;
+};
+
+}  // namespace niceshade
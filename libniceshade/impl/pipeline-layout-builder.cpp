@@ -24,6 +24,10 @@
 
 #include "impl/error-macros.h"
 
+#include <algorithm>
+#include <new>
+#include <string>
+
 namespace niceshade {
 
 namespace {
@@ -46,16 +50,38 @@ error pipeline_layout_builder::process_resources(
     bool                                                   preserve_bindings) noexcept {
   for (const auto& r : resources) {
     if (!should_process_resource(r.id, refl, preserve_bindings)) { continue; }
+    // SPIRV-Cross names buffers after their block type, which several buffers may share, so
+    // descriptors are named after their variables when possible.
+    const std::string& var_name    = refl.get_name(r.id);
+    const std::string& source_name = var_name.empty() ? r.name : var_name;
     uint32_t set_idx     = refl.get_decoration(r.id, spv::DecorationDescriptorSet);
     uint32_t binding_idx = refl.get_decoration(r.id, spv::DecorationBinding);
+    if (set_idx > max_descriptor_set_index) {
+      NICESHADE_RETURN_ERROR(
+          "Descriptor set ",
+          set_idx,
+          " of ",
+          source_name.c_str(),
+          " exceeds the maximum supported set index ",
+          max_descriptor_set_index);
+    }
     max_set_             = max_set_ < set_idx ? set_idx : max_set_;
-    descriptor& desc     = sets_[set_idx][binding_idx];
+    const uint64_t key   = make_key(set_idx, binding_idx);
+    const auto [index_it, inserted] =
+        descriptor_indices_.emplace(key, (uint32_t)descriptors_.size());
+    if (inserted) { descriptors_.emplace_back(keyed_descriptor {key, descriptor {}}); }
+    descriptor& desc = descriptors_[index_it->second].desc;
     if (desc.type == descriptor_type::INVALID) {
       // This resource hasn't been encountered before.
       desc.slot = binding_idx;
       desc.type = resource_type;
-      desc.name = r.name;
+      desc.name = strings_->intern(source_name);
       nres_++;
+      if (resource_type == descriptor_type::UNIFORM_BUFFER ||
+          resource_type == descriptor_type::STORAGE_BUFFER) {
+        NICESHADE_DECLARE_OR_RETURN(block_idx, add_block(refl, r.base_type_id));
+        descriptors_[index_it->second].block = block_idx;
+      }
     }
     if (desc.type != descriptor_type::INVALID && desc.type != resource_type) {
       NICESHADE_RETURN_ERROR(
@@ -65,15 +91,15 @@ error pipeline_layout_builder::process_resources(
           " in set ",
           set_idx,
           " which is already occupied by ",
-          desc.name.c_str());
+          desc.name);
     }
-    if (desc.type != descriptor_type::INVALID && r.name != desc.name) {
+    if (desc.type != descriptor_type::INVALID && source_name != desc.name) {
       NICESHADE_RETURN_ERROR(
           "Assigning different names "
           "(\"",
-          desc.name.c_str(),
+          desc.name,
           "\" and \"",
-          r.name.c_str(),
+          source_name.c_str(),
           "\")  to descriptor at slot ",
           binding_idx,
           " in set ",
@@ -84,7 +110,7 @@ error pipeline_layout_builder::process_resources(
     if (r_type.array.size() > 1u) { NICESHADE_RETURN_ERROR("Array of arrays in descriptors not supported."); }
     desc.is_array = r_type.array.size() > 0u;
     desc.array_size = r_type.array_size_literal[0] ? r_type.array[0] : (~0u);
-    desc_usages_.add(set_idx, binding_idx, std::make_pair(&refl, r.id));
+    desc_usages_.emplace_back(keyed_descriptor_usage {key, std::make_pair(&refl, r.id)});
   }
   return error {};
 }
@@ -92,33 +118,108 @@ error pipeline_layout_builder::process_resources(
  error pipeline_layout_builder::process_push_const(
     const spirv_cross::SmallVector<spirv_cross::Resource>& r,
     spirv_cross::Compiler&                                 refl) noexcept {
-  for (const auto& res : r) { push_const_usages_.emplace_back(std::make_pair(&refl, res.id)); }
+  for (const auto& res : r) {
+    push_const_usages_.emplace_back(std::make_pair(&refl, res.id));
+    if (push_const_block_ == ~0u) {
+      NICESHADE_DECLARE_OR_RETURN(block_idx, add_block(refl, res.base_type_id));
+      push_const_block_ = block_idx;
+    }
+  }
   return error {};
 }
 
+value_or_error<uint32_t> pipeline_layout_builder::add_block(
+    const spirv_cross::Compiler& refl,
+    spirv_cross::TypeID          block_type_id) noexcept {
+  try {
+    const spirv_cross::SPIRType& block_type   = refl.get_type(block_type_id);
+    uint32_t                     block_idx    = (uint32_t)blocks_.size();
+    const uint32_t               first_member = (uint32_t)block_members_.size();
+    add_block_members(refl, block_type, 0u, std::string {});
+    blocks_.emplace_back(pipeline_layout::block_range {
+        (uint32_t)refl.get_declared_struct_size(block_type),
+        first_member,
+        (uint32_t)block_members_.size() - first_member});
+    return block_idx;
+  } catch (spirv_cross::CompilerError& ce) {
+    NICESHADE_RETURN_ERROR(ce.what());
+  } catch (std::bad_alloc&) { NICESHADE_RETURN_ERROR("out of memory while reflecting blocks"); }
+}
+
+void pipeline_layout_builder::add_block_members(
+    const spirv_cross::Compiler& refl,
+    const spirv_cross::SPIRType& struct_type,
+    uint32_t                     base_offset,
+    const std::string&           name_prefix) {
+  for (uint32_t m = 0u; m < (uint32_t)struct_type.member_types.size(); ++m) {
+    const spirv_cross::SPIRType& member_type = refl.get_type(struct_type.member_types[m]);
+    // Unnamed members are named the same way that SPIRV-Cross names them in generated code.
+    const std::string& member_name = refl.get_member_name(struct_type.self, m);
+    const std::string  name =
+        name_prefix + (member_name.empty() ? "_m" + std::to_string(m) : member_name);
+    block_member      member {};
+    member.name     = strings_->intern(name);
+    member.offset   = base_offset + refl.type_struct_member_offset(struct_type, m);
+    member.vecsize  = member_type.vecsize;
+    member.columns  = member_type.columns;
+    member.is_array = !member_type.array.empty();
+    if (member.is_array) {
+      // The outermost dimension of an array of arrays is the last one. Arrays sized with
+      // specialization constants and runtime-sized arrays do not have a size known at compile time.
+      const bool size_known =
+          member_type.array_size_literal.back() && member_type.array.back() != 0u;
+      member.array_size   = size_known ? member_type.array.back() : ~0u;
+      member.array_stride = refl.type_struct_member_array_stride(struct_type, m);
+    }
+    if (!member.is_array || member.array_size != ~0u) {
+      member.size = (uint32_t)refl.get_declared_struct_member_size(struct_type, m);
+    }
+    if (member_type.columns > 1u) {
+      member.matrix_stride = refl.type_struct_member_matrix_stride(struct_type, m);
+      member.row_major =
+          refl.has_member_decoration(struct_type.self, m, spv::DecorationRowMajor);
+    }
+    block_members_.emplace_back(member);
+    if (member_type.basetype == spirv_cross::SPIRType::Struct) {
+      add_block_members(
+          refl,
+          member_type,
+          member.offset,
+          name + (member.is_array ? "[0]." : "."));
+    }
+  }
+}
+
 bool pipeline_layout_builder::remap_resources() noexcept {
+  // Native bindings are assigned in order of set and binding, so sort everything by key first.
+  // Both arrays are then walked in lockstep.
+  std::sort(descriptors_.begin(), descriptors_.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.key < rhs.key;
+  });
+  std::stable_sort(desc_usages_.begin(), desc_usages_.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.key < rhs.key;
+  });
+
   uint32_t num_descriptors_of_type[(int)descriptor_type::INVALID] = {0u};
-  for (auto& set_id_and_layout : sets_) {
-    for (auto& binding_id_and_descriptor : set_id_and_layout.second) {
-      const auto& desc = binding_id_and_descriptor.second;
-      if (desc.is_array && desc.array_size == ~0u) {
-        return false;
-      }
-      auto desc_type = desc.type;
-      if (desc_type == descriptor_type::LOADSTORE_IMAGE) desc_type = descriptor_type::TEXTURE;
-      if (desc_type == descriptor_type::STORAGE_BUFFER) desc_type = descriptor_type::UNIFORM_BUFFER;
-      if (desc_type == descriptor_type::ACCELERATION_STRUCTURE) desc_type = descriptor_type::UNIFORM_BUFFER;
-      const uint32_t native_binding = (num_descriptors_of_type[(int)desc_type]);
-      const uint32_t binding_shift  = !desc.is_array ? 1u : desc.array_size;
-      num_descriptors_of_type[(int)desc_type] += binding_shift;
-      binding_id_and_descriptor.second.native_binding = native_binding;
-      for (auto& compiler_and_id :
-           desc_usages_.get_usages(set_id_and_layout.first, binding_id_and_descriptor.first)) {
-        compiler_and_id.first->set_decoration(
-            compiler_and_id.second,
-            spv::DecorationBinding,
-            native_binding);
-      }
+  auto     usage_it = desc_usages_.begin();
+  for (auto& keyed_desc : descriptors_) {
+    auto& desc = keyed_desc.desc;
+    if (desc.is_array && desc.array_size == ~0u) {
+      return false;
+    }
+    auto desc_type = desc.type;
+    if (desc_type == descriptor_type::LOADSTORE_IMAGE) desc_type = descriptor_type::TEXTURE;
+    if (desc_type == descriptor_type::STORAGE_BUFFER) desc_type = descriptor_type::UNIFORM_BUFFER;
+    if (desc_type == descriptor_type::ACCELERATION_STRUCTURE) desc_type = descriptor_type::UNIFORM_BUFFER;
+    const uint32_t native_binding = (num_descriptors_of_type[(int)desc_type]);
+    const uint32_t binding_shift  = !desc.is_array ? 1u : desc.array_size;
+    num_descriptors_of_type[(int)desc_type] += binding_shift;
+    desc.native_binding = native_binding;
+    for (; usage_it != desc_usages_.end() && usage_it->key == keyed_desc.key; ++usage_it) {
+      usage_it->usage.first->set_decoration(
+          usage_it->usage.second,
+          spv::DecorationBinding,
+          native_binding);
     }
   }
 
@@ -138,16 +239,56 @@ value_or_error<pipeline_layout> pipeline_layout_builder::build() noexcept {
         "Failed to remap resources -- array sizes must be known at compile time.");
   }
 
-  pipeline_layout layout;
-  layout.sets_    = std::move(sets_);
+  pipeline_layout layout {resource_};
+  layout.descriptors_.reserve(descriptors_.size());
+  layout.descriptor_blocks_.reserve(descriptors_.size());
+  layout.set_lut_.assign(descriptors_.empty() ? 0u : max_set_ + 1u, ~0u);
+  for (size_t d = 0u; d < descriptors_.size();) {
+    // Find the range of descriptors belonging to the current set.
+    const uint32_t set_id  = (uint32_t)(descriptors_[d].key >> 32u);
+    size_t         set_end = d + 1u;
+    while (set_end < descriptors_.size() &&
+           (uint32_t)(descriptors_[set_end].key >> 32u) == set_id) {
+      ++set_end;
+    }
+    const uint32_t count    = (uint32_t)(set_end - d);
+    const uint32_t max_slot = descriptors_[set_end - 1u].desc.slot;
+
+    // Build a dense binding lookup table, unless the bindings are too sparse for that to be
+    // reasonable (in which case lookups fall back to binary search).
+    const uint32_t lut_size = (max_slot / 4u <= count + 16u) ? max_slot + 1u : 0u;
+    layout.set_lut_[set_id] = (uint32_t)layout.set_ranges_.size();
+    layout.set_ranges_.emplace_back(pipeline_layout::set_range {
+        set_id,
+        (uint32_t)layout.descriptors_.size(),
+        count,
+        (uint32_t)layout.binding_lut_.size(),
+        lut_size});
+    const size_t lut_begin = layout.binding_lut_.size();
+    layout.binding_lut_.resize(lut_begin + lut_size, ~0u);
+    for (uint32_t i = 0u; i < count; ++i) {
+      descriptor& desc = descriptors_[d + i].desc;
+      if (lut_size > 0u) { layout.binding_lut_[lut_begin + desc.slot] = i; }
+      layout.descriptors_.emplace_back(std::move(desc));
+      layout.descriptor_blocks_.emplace_back(descriptors_[d + i].block);
+    }
+    d = set_end;
+  }
   layout.max_set_ = max_set_;
   layout.nres_    = nres_;
   if (!push_const_usages_.empty()) { layout.push_consts_native_binding_ = push_const_native_binding_; }
-  sets_           = decltype(sets_) {};
-  max_set_        = 0u;
-  nres_           = 0u;
+  layout.blocks_.assign(blocks_.begin(), blocks_.end());
+  layout.block_members_.assign(block_members_.begin(), block_members_.end());
+  layout.push_consts_block_ = push_const_block_;
+  descriptors_.clear();
+  descriptor_indices_.clear();
+  max_set_ = 0u;
+  nres_    = 0u;
   desc_usages_.clear();
   push_const_usages_.clear();
+  blocks_.clear();
+  block_members_.clear();
+  push_const_block_ = ~0u;
 
   return std::move(layout);
 }
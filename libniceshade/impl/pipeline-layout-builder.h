@@ -24,15 +24,28 @@
 
 #include "libniceshade/error.h"
 #include "libniceshade/pipeline-layout.h"
+#include "libniceshade/string-pool.h"
 #include "spirv_reflect.hpp"
 
-#include <map>
+#include <memory_resource>
+#include <unordered_map>
 #include <vector>
 
 namespace niceshade {
 
 class pipeline_layout_builder {
 public:
+  pipeline_layout_builder(string_pool& strings, std::pmr::memory_resource* resource) noexcept
+      : strings_ {&strings},
+        resource_ {resource},
+        descriptors_ {resource},
+        descriptor_indices_ {resource},
+        desc_usages_ {resource},
+        push_const_usages_ {resource},
+        blocks_ {resource},
+        block_members_ {resource} {
+  }
+
   error process_resources(
       const spirv_cross::SmallVector<spirv_cross::Resource>& resources,
       descriptor_type                                        resource_type,
@@ -46,35 +59,47 @@ public:
 private:
   bool remap_resources() noexcept;
 
+  // Reflects the memory layout of the given block type, and returns its index in blocks_.
+  value_or_error<uint32_t> add_block(
+      const spirv_cross::Compiler& refl,
+      spirv_cross::TypeID          block_type_id) noexcept;
+  // Appends the members of the given structure, and the members of structures nested in it, to
+  // block_members_. May throw spirv_cross::CompilerError.
+  void add_block_members(
+      const spirv_cross::Compiler& refl,
+      const spirv_cross::SPIRType& struct_type,
+      uint32_t                     base_offset,
+      const std::string&           name_prefix);
+
+  static constexpr uint64_t make_key(uint64_t set, uint64_t binding) noexcept {
+    return (set << (uint64_t)32) | binding;
+  }
+
   using descriptor_usage = std::pair<spirv_cross::Compiler*, spirv_cross::ID>;
-  class descriptor_usage_map {
-  private:
-    static constexpr uint64_t make_key(uint64_t a, uint64_t b) noexcept {
-      return (a << (uint64_t)32) | b;
-    }
-
-  public:
-    void add(uint32_t set, uint32_t binding, descriptor_usage usage) noexcept {
-      descriptor_usages_[make_key(set, binding)].emplace_back(usage);
-    }
-    const std::vector<descriptor_usage>& get_usages(uint32_t set, uint32_t binding) noexcept {
-      return descriptor_usages_[make_key(set, binding)];
-    }
-
-    void clear() noexcept { descriptor_usages_.clear(); }
-
-  private:
-    std::map<uint64_t, std::vector<descriptor_usage>> descriptor_usages_;
+  struct keyed_descriptor {
+    uint64_t   key;  // Descriptor set and binding, see make_key.
+    descriptor desc;
+    uint32_t   block = ~0u;  // Index into blocks_ for buffers, ~0u otherwise.
+  };
+  struct keyed_descriptor_usage {
+    uint64_t         key;  // Descriptor set and binding, see make_key.
+    descriptor_usage usage;
   };
 
-  std::map<uint32_t, descriptor_set_layout>
-                       sets_;  // shouldn't be undordered_map to guarantee consistent order.
-  descriptor_usage_map desc_usages_;
-  uint32_t             max_set_ = 0u;  // Max set number encountered.
-  uint32_t             nres_    = 0u;  // Total number of resources.
+  string_pool*                                strings_;   // Descriptor names are interned here.
+  std::pmr::memory_resource*                  resource_;  // Used for the built layout too.
+  std::pmr::vector<keyed_descriptor>          descriptors_;  // In order of first encounter.
+  std::pmr::unordered_map<uint64_t, uint32_t> descriptor_indices_;  // Key -> descriptors_ index.
+  std::pmr::vector<keyed_descriptor_usage>    desc_usages_;
+  uint32_t                                    max_set_ = 0u;  // Max set number encountered.
+  uint32_t                                    nres_    = 0u;  // Total number of resources.
 
-  std::vector<descriptor_usage> push_const_usages_;
+  std::pmr::vector<descriptor_usage> push_const_usages_;
   uint32_t push_const_native_binding_ = 0u;
+
+  std::pmr::vector<pipeline_layout::block_range> blocks_;
+  std::pmr::vector<block_member>                 block_members_;
+  uint32_t                                       push_const_block_ = ~0u;  // Index into blocks_.
 };
 
 constexpr uint32_t AUTOGEN_CIS_DESCRIPTOR_SET = 9999u;
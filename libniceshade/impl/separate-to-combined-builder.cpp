@@ -24,6 +24,8 @@
 
 #include "impl/error-macros.h"
 
+#include <algorithm>
+
 namespace niceshade {
 
 void separate_to_combined_builder::add_resource(
@@ -33,9 +35,39 @@ void separate_to_combined_builder::add_resource(
   uint32_t set_id              = compiler.get_decoration(separate_id, spv::DecorationDescriptorSet);
   uint32_t binding_id          = compiler.get_decoration(separate_id, spv::DecorationBinding);
   uint32_t combined_binding_id = compiler.get_decoration(combined_id, spv::DecorationBinding);
-  map_[set_and_binding {set_id, binding_id}].insert(combined_binding_id);
+  mappings_.emplace_back(mapping {set_and_binding {set_id, binding_id}, combined_binding_id});
 }
 
-separate_to_combined_map separate_to_combined_builder::build() noexcept { return std::move(map_); }
+separate_to_combined_map separate_to_combined_builder::build() noexcept {
+  // The same mapping may have been added several times (e.g. once per target), so sort and
+  // deduplicate before grouping mappings by resource.
+  std::sort(mappings_.begin(), mappings_.end(), [](const mapping& lhs, const mapping& rhs) {
+    return lhs.resource < rhs.resource ||
+           (lhs.resource == rhs.resource && lhs.combined_id < rhs.combined_id);
+  });
+  mappings_.erase(
+      std::unique(
+          mappings_.begin(),
+          mappings_.end(),
+          [](const mapping& lhs, const mapping& rhs) {
+            return lhs.resource == rhs.resource && lhs.combined_id == rhs.combined_id;
+          }),
+      mappings_.end());
+
+  separate_to_combined_map result {resource_};
+  result.combined_ids_.reserve(mappings_.size());
+  for (const mapping& m : mappings_) {
+    if (result.records_.empty() || !(result.records_.back().resource == m.resource)) {
+      result.records_.emplace_back(separate_to_combined_map::record {
+          m.resource,
+          (uint32_t)result.combined_ids_.size(),
+          0u});
+    }
+    result.combined_ids_.push_back(m.combined_id);
+    ++result.records_.back().combined_id_count;
+  }
+  mappings_.clear();
+  return result;
+}
 
 }  // namespace niceshade
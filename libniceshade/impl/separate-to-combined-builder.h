@@ -23,11 +23,20 @@
 #pragma once
 
 #include "libniceshade/separate-to-combined-map.h"
+#include "spirv_cross.hpp"
+
+#include <memory_resource>
+#include <vector>
 
 namespace niceshade {
 
 class separate_to_combined_builder {
 public:
+  explicit separate_to_combined_builder(std::pmr::memory_resource* resource) noexcept
+      : resource_ {resource},
+        mappings_ {resource} {
+  }
+
   void add_resource(
       uint32_t                     separate_id,
       uint32_t                     combined_id,
@@ -35,7 +44,12 @@ public:
   separate_to_combined_map build() noexcept;
 
 private:
-  separate_to_combined_map map_;
+  struct mapping {
+    set_and_binding resource;
+    uint32_t        combined_id;
+  };
+  std::pmr::memory_resource* resource_;  // Used for the built map too.
+  std::pmr::vector<mapping>  mappings_;
 };
 
 };  // namespace niceshade
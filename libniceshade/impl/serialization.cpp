@@ -0,0 +1,693 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "libniceshade/serialization.h"
+
+#include "impl/error-macros.h"
+
+#include <string.h>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+namespace niceshade {
+
+namespace {
+
+/*
+ * Serialized techniques are laid out as a file header followed by 8-byte aligned sections. Every
+ * section is an array of fixed-size records (or raw bytes), and is referred to by an `array_ref`
+ * holding its offset from the start of the data and its element count. Strings are stored once, in
+ * a null-terminated string table, and referred to by their index in it. Loaded techniques refer to
+ * the string table directly.
+ */
+
+constexpr char     serialized_magic[4] = {'N', 'S', 'C', 'T'};
+constexpr uint32_t byte_order_marker   = 0x01020304u;
+constexpr size_t   section_alignment   = 8u;
+
+struct array_ref {
+  uint64_t offset;
+  uint64_t count;
+};
+
+struct file_header {
+  char      magic[4];
+  uint32_t  version;
+  uint32_t  byte_order;
+  uint32_t  reserved;
+  uint64_t  total_size;
+  array_ref strings;      // string_record[]
+  array_ref string_data;  // char[]
+  array_ref techniques;   // technique_record[]
+};
+
+struct string_record {
+  uint32_t offset;  // Relative to the start of the string data section.
+  uint32_t size;    // Not counting the null terminator.
+};
+
+struct descriptor_record {
+  uint32_t slot;
+  uint32_t type;
+  uint32_t stage_mask;
+  uint32_t name;
+  uint32_t native_binding;
+  uint32_t is_array;
+  uint32_t array_size;
+  uint32_t reserved;
+};
+
+struct block_member_record {
+  uint32_t name;
+  uint32_t offset;
+  uint32_t size;
+  uint32_t vecsize;
+  uint32_t columns;
+  uint32_t is_array;
+  uint32_t array_size;
+  uint32_t array_stride;
+  uint32_t matrix_stride;
+  uint32_t row_major;
+};
+
+struct spec_const_record {
+  uint32_t name;
+  uint32_t id;
+  uint32_t type_id;
+  uint32_t reserved;
+};
+
+struct interface_variable_record {
+  uint32_t name;
+  uint32_t base_type;
+  uint32_t vecsize;
+  uint32_t location_decoration;
+};
+
+struct interface_record {
+  uint32_t  stage;
+  uint32_t  reserved;
+  array_ref input_vars;   // interface_variable_record[]
+  array_ref output_vars;  // interface_variable_record[]
+};
+
+struct stage_record {
+  uint32_t  stage;
+  uint32_t  has_threadgroup_size;
+  uint32_t  threadgroup_size[3];
+  uint32_t  codegen_passes;
+  uint32_t  stripped_debug_bytes;
+  uint32_t  reserved;
+  array_ref code;  // std::byte[]
+};
+
+struct targeted_output_record {
+  uint32_t  api;
+  uint32_t  version_maj;
+  uint32_t  version_min;
+  uint32_t  platform;
+  array_ref stages;  // stage_record[]
+};
+
+struct technique_record {
+  uint32_t  name;
+  uint32_t  max_set;
+  uint32_t  res_count;
+  uint32_t  has_push_consts_native_binding;
+  uint32_t  push_consts_native_binding;
+  uint32_t  push_consts_block;
+  array_ref descriptors;          // descriptor_record[]
+  array_ref set_ranges;           // pipeline_layout::set_range[]
+  array_ref set_lut;              // uint32_t[]
+  array_ref binding_lut;          // uint32_t[]
+  array_ref blocks;               // pipeline_layout::block_range[]
+  array_ref block_members;        // block_member_record[]
+  array_ref descriptor_blocks;    // uint32_t[]
+  array_ref spec_consts;          // spec_const_record[]
+  array_ref image_map_records;    // separate_to_combined_map::record[]
+  array_ref image_map_ids;        // uint32_t[]
+  array_ref sampler_map_records;  // separate_to_combined_map::record[]
+  array_ref sampler_map_ids;      // uint32_t[]
+  array_ref interfaces;           // interface_record[]
+  array_ref targeted_outputs;     // targeted_output_record[]
+};
+
+static_assert(sizeof(file_header) % section_alignment == 0u);
+static_assert(sizeof(technique_record) % section_alignment == 0u);
+static_assert(sizeof(interface_record) % section_alignment == 0u);
+static_assert(sizeof(stage_record) % section_alignment == 0u);
+static_assert(sizeof(targeted_output_record) % section_alignment == 0u);
+
+// Appends sections to the serialized data.
+class blob_writer {
+public:
+  explicit blob_writer(size_t size_estimate) {
+    data_.reserve(size_estimate);
+    data_.resize(sizeof(file_header));
+  }
+
+  template<class T> array_ref append(const T* items, size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    data_.resize((data_.size() + section_alignment - 1u) & ~(section_alignment - 1u));
+    const array_ref ref {data_.size(), count};
+    if (count > 0u) {
+      data_.resize(data_.size() + count * sizeof(T));
+      memcpy(data_.data() + ref.offset, items, count * sizeof(T));
+    }
+    return ref;
+  }
+
+  template<class T, class A> array_ref append(const std::vector<T, A>& items) {
+    return append(items.data(), items.size());
+  }
+
+  std::vector<std::byte>& data() noexcept { return data_; }
+
+private:
+  std::vector<std::byte> data_;
+};
+
+// Collects distinct strings and assigns indices to them.
+class string_table_builder {
+public:
+  uint32_t add(std::string_view str) {
+    auto it = indices_.find(str);
+    if (it != indices_.end()) { return it->second; }
+    const uint32_t index = (uint32_t)records_.size();
+    records_.push_back(string_record {(uint32_t)chars_.size(), (uint32_t)str.size()});
+    chars_.insert(chars_.end(), str.begin(), str.end());
+    chars_.push_back('\0');
+    indices_.emplace(str, index);
+    return index;
+  }
+
+  const std::vector<string_record>& records() const noexcept { return records_; }
+  const std::vector<char>&          chars() const noexcept { return chars_; }
+
+private:
+  std::unordered_map<std::string_view, uint32_t> indices_;
+  std::vector<string_record>                     records_;
+  std::vector<char>                              chars_;
+};
+
+// Provides bounds-checked access to sections of the serialized data. Once an access fails, the
+// reader remembers it, and every subsequent access yields an empty span.
+class blob_reader {
+public:
+  explicit blob_reader(const_span<std::byte> data) noexcept : data_ {data} {}
+
+  template<class T> const_span<T> get(const array_ref& ref) noexcept {
+    if (failed_ || ref.count == 0u) { return const_span<T> {}; }
+    if (ref.offset % alignof(T) != 0u || ref.offset > data_.size() ||
+        ref.count > (data_.size() - ref.offset) / sizeof(T)) {
+      failed_ = true;
+      return const_span<T> {};
+    }
+    return const_span<T> {reinterpret_cast<const T*>(data_.data() + ref.offset), ref.count};
+  }
+
+  bool failed() const noexcept { return failed_; }
+  void fail() noexcept { failed_ = true; }
+
+private:
+  const_span<std::byte> data_;
+  bool                  failed_ = false;
+};
+
+}  // namespace
+
+class technique_serializer {
+public:
+  static std::vector<std::byte> write(const compiled_techniques& techniques);
+  static value_or_error<compiled_techniques> read(
+      const_span<std::byte>       data,
+      std::shared_ptr<const void> owner,
+      std::pmr::memory_resource*  resource) noexcept;
+
+private:
+  static bool read_layout(
+      const technique_record&              rec,
+      blob_reader&                         reader,
+      const std::vector<std::string_view>& names,
+      pipeline_layout&                     layout) noexcept;
+  static bool read_separate_to_combined_map(
+      const array_ref&          records,
+      const array_ref&          ids,
+      blob_reader&              reader,
+      separate_to_combined_map& map) noexcept;
+};
+
+std::vector<std::byte> technique_serializer::write(const compiled_techniques& techniques) {
+  // Shader code is the bulk of the data, so reserve enough space for it up front.
+  size_t code_size = 0u;
+  for (const compiled_technique& tech : techniques) {
+    for (const targeted_output& target_out : tech.targeted_outputs) {
+      for (const compiled_stage& stage : target_out.stages) {
+        code_size += stage.result.data().size() + section_alignment;
+      }
+    }
+  }
+  blob_writer                   writer {code_size + techniques.size() * 1024u};
+  string_table_builder          strings;
+  std::vector<technique_record> technique_records;
+  technique_records.reserve(techniques.size());
+
+  for (const compiled_technique& tech : techniques) {
+    technique_record rec {};
+    rec.name = strings.add(tech.name);
+
+    const pipeline_layout&         layout = tech.layout;
+    std::vector<descriptor_record> descriptors;
+    descriptors.reserve(layout.descriptors_.size());
+    for (const descriptor& desc : layout.descriptors_) {
+      descriptors.push_back(descriptor_record {
+          desc.slot,
+          (uint32_t)desc.type,
+          desc.stage_mask,
+          strings.add(desc.name),
+          desc.native_binding,
+          desc.is_array ? 1u : 0u,
+          desc.array_size,
+          0u});
+    }
+    rec.max_set                        = layout.max_set_;
+    rec.res_count                      = layout.nres_;
+    rec.has_push_consts_native_binding = layout.push_consts_native_binding_.has_value() ? 1u : 0u;
+    rec.push_consts_native_binding     = layout.push_consts_native_binding_.value_or(0u);
+    rec.descriptors                    = writer.append(descriptors);
+    rec.set_ranges                     = writer.append(layout.set_ranges_);
+    rec.set_lut                        = writer.append(layout.set_lut_);
+    rec.binding_lut                    = writer.append(layout.binding_lut_);
+
+    std::vector<block_member_record> block_members;
+    block_members.reserve(layout.block_members_.size());
+    for (const block_member& member : layout.block_members_) {
+      block_members.push_back(block_member_record {
+          strings.add(member.name),
+          member.offset,
+          member.size,
+          member.vecsize,
+          member.columns,
+          member.is_array ? 1u : 0u,
+          member.array_size,
+          member.array_stride,
+          member.matrix_stride,
+          member.row_major ? 1u : 0u});
+    }
+    rec.push_consts_block = layout.push_consts_block_;
+    rec.blocks            = writer.append(layout.blocks_);
+    rec.block_members     = writer.append(block_members);
+    rec.descriptor_blocks = writer.append(layout.descriptor_blocks_);
+
+    std::vector<spec_const_record> spec_consts;
+    spec_consts.reserve(tech.spec_consts.size());
+    for (const auto& [name, constant] : tech.spec_consts) {
+      spec_consts.push_back(
+          spec_const_record {strings.add(name), constant.id, constant.type_id, 0u});
+    }
+    rec.spec_consts = writer.append(spec_consts);
+
+    rec.image_map_records   = writer.append(tech.image_map.records_);
+    rec.image_map_ids       = writer.append(tech.image_map.combined_ids_);
+    rec.sampler_map_records = writer.append(tech.sampler_map.records_);
+    rec.sampler_map_ids     = writer.append(tech.sampler_map.combined_ids_);
+
+    std::vector<interface_record>          interfaces;
+    std::vector<interface_variable_record> vars;
+    auto append_vars = [&](const arena_vector<interface_variable>& src) {
+      vars.clear();
+      for (const interface_variable& v : src) {
+        vars.push_back(interface_variable_record {
+            strings.add(v.name),
+            (uint32_t)v.base_type,
+            v.vecsize,
+            v.location_decoration});
+      }
+      return writer.append(vars);
+    };
+    for (const interface_variables& iface : tech.per_stage_interface) {
+      interface_record iface_rec {};
+      iface_rec.stage       = (uint32_t)iface.stage;
+      iface_rec.input_vars  = append_vars(iface.input_vars);
+      iface_rec.output_vars = append_vars(iface.output_vars);
+      interfaces.push_back(iface_rec);
+    }
+    rec.interfaces = writer.append(interfaces);
+
+    std::vector<targeted_output_record> outputs;
+    std::vector<stage_record>           stages;
+    for (const targeted_output& target_out : tech.targeted_outputs) {
+      stages.clear();
+      for (const compiled_stage& stage : target_out.stages) {
+        stage_record stage_rec {};
+        stage_rec.stage                = (uint32_t)stage.stage;
+        stage_rec.has_threadgroup_size = stage.threadgroup_size.has_value() ? 1u : 0u;
+        if (stage.threadgroup_size) {
+          memcpy(stage_rec.threadgroup_size, stage.threadgroup_size->data(), sizeof(uint32_t) * 3u);
+        }
+        stage_rec.codegen_passes       = stage.stats.codegen_passes;
+        stage_rec.stripped_debug_bytes = stage.stats.stripped_debug_bytes;
+        stage_rec.code = writer.append(stage.result.data().data(), stage.result.data().size());
+        stages.push_back(stage_rec);
+      }
+      outputs.push_back(targeted_output_record {
+          (uint32_t)target_out.target.api,
+          target_out.target.version_maj,
+          target_out.target.version_min,
+          (uint32_t)target_out.target.platform,
+          writer.append(stages)});
+    }
+    rec.targeted_outputs = writer.append(outputs);
+    technique_records.push_back(rec);
+  }
+
+  file_header header {};
+  memcpy(header.magic, serialized_magic, sizeof(header.magic));
+  header.version     = serialized_techniques_version;
+  header.byte_order  = byte_order_marker;
+  header.techniques  = writer.append(technique_records);
+  header.strings     = writer.append(strings.records());
+  header.string_data = writer.append(strings.chars());
+
+  std::vector<std::byte>& data = writer.data();
+  header.total_size            = data.size();
+  memcpy(data.data(), &header, sizeof(header));
+  return std::move(data);
+}
+
+bool technique_serializer::read_layout(
+    const technique_record&              rec,
+    blob_reader&                         reader,
+    const std::vector<std::string_view>& names,
+    pipeline_layout&                     layout) noexcept {
+  using set_range                                = pipeline_layout::set_range;
+  using block_range                              = pipeline_layout::block_range;
+  const const_span<descriptor_record>   descs    = reader.get<descriptor_record>(rec.descriptors);
+  const const_span<set_range>           sets     = reader.get<set_range>(rec.set_ranges);
+  const const_span<uint32_t>            set_lut  = reader.get<uint32_t>(rec.set_lut);
+  const const_span<uint32_t>            bind_lut = reader.get<uint32_t>(rec.binding_lut);
+  const const_span<block_range>         blocks   = reader.get<block_range>(rec.blocks);
+  const const_span<block_member_record> members =
+      reader.get<block_member_record>(rec.block_members);
+  const const_span<uint32_t> desc_blocks = reader.get<uint32_t>(rec.descriptor_blocks);
+  if (reader.failed()) { return false; }
+
+  // Validate everything that lookups rely on, so that malformed data can never make them read out
+  // of bounds or return a descriptor other than the one asked for. The set lookup table has to
+  // cover every set up to max_set, and each binding lookup table has to agree with the slots of the
+  // descriptors in its set.
+  if (rec.max_set > max_descriptor_set_index ||
+      set_lut.size() != (descs.size() == 0u ? 0u : rec.max_set + 1u)) {
+    return false;
+  }
+  for (uint32_t set_id = 0u; set_id < set_lut.size(); ++set_id) {
+    const uint32_t entry = set_lut[set_id];
+    if (entry != ~0u && (entry >= sets.size() || sets[entry].set_id != set_id)) { return false; }
+  }
+  for (size_t r = 0u; r < sets.size(); ++r) {
+    const set_range& range = sets[r];
+    if (range.set_id >= set_lut.size() || set_lut[range.set_id] != r ||
+        range.first_descriptor > descs.size() ||
+        range.descriptor_count > descs.size() - range.first_descriptor ||
+        range.first_lut_entry > bind_lut.size() ||
+        range.lut_size > bind_lut.size() - range.first_lut_entry) {
+      return false;
+    }
+    for (uint32_t i = 0u; i < range.lut_size; ++i) {
+      const uint32_t entry = bind_lut[range.first_lut_entry + i];
+      if (entry != ~0u &&
+          (entry >= range.descriptor_count || descs[range.first_descriptor + entry].slot != i)) {
+        return false;
+      }
+    }
+    for (uint32_t i = 0u; i < range.descriptor_count; ++i) {
+      const uint32_t slot = descs[range.first_descriptor + i].slot;
+      if ((i > 0u && slot <= descs[range.first_descriptor + i - 1u].slot) ||
+          (range.lut_size > 0u &&
+           (slot >= range.lut_size || bind_lut[range.first_lut_entry + slot] != i))) {
+        return false;
+      }
+    }
+  }
+  for (const block_range& range : blocks) {
+    if (range.first_member > members.size() ||
+        range.member_count > members.size() - range.first_member) {
+      return false;
+    }
+  }
+  if (desc_blocks.size() != descs.size() ||
+      (rec.push_consts_block != ~0u && rec.push_consts_block >= blocks.size())) {
+    return false;
+  }
+  for (uint32_t entry : desc_blocks) {
+    if (entry != ~0u && entry >= blocks.size()) { return false; }
+  }
+
+  layout.descriptors_.reserve(descs.size());
+  for (const descriptor_record& d : descs) {
+    if (d.name >= names.size() || d.type > (uint32_t)descriptor_type::INVALID) { return false; }
+    descriptor& desc    = layout.descriptors_.emplace_back();
+    desc.slot           = d.slot;
+    desc.type           = (descriptor_type)d.type;
+    desc.stage_mask     = d.stage_mask;
+    desc.name           = names[d.name];
+    desc.native_binding = d.native_binding;
+    desc.is_array       = d.is_array != 0u;
+    desc.array_size     = d.array_size;
+  }
+  layout.set_ranges_.assign(sets.begin(), sets.end());
+  layout.set_lut_.assign(set_lut.begin(), set_lut.end());
+  layout.binding_lut_.assign(bind_lut.begin(), bind_lut.end());
+  layout.block_members_.reserve(members.size());
+  for (const block_member_record& m : members) {
+    if (m.name >= names.size()) { return false; }
+    block_member& member = layout.block_members_.emplace_back();
+    member.name          = names[m.name];
+    member.offset        = m.offset;
+    member.size          = m.size;
+    member.vecsize       = m.vecsize;
+    member.columns       = m.columns;
+    member.is_array      = m.is_array != 0u;
+    member.array_size    = m.array_size;
+    member.array_stride  = m.array_stride;
+    member.matrix_stride = m.matrix_stride;
+    member.row_major     = m.row_major != 0u;
+  }
+  layout.blocks_.assign(blocks.begin(), blocks.end());
+  layout.descriptor_blocks_.assign(desc_blocks.begin(), desc_blocks.end());
+  layout.push_consts_block_ = rec.push_consts_block;
+  layout.max_set_ = rec.max_set;
+  layout.nres_    = rec.res_count;
+  if (rec.has_push_consts_native_binding) {
+    layout.push_consts_native_binding_ = rec.push_consts_native_binding;
+  }
+  return true;
+}
+
+bool technique_serializer::read_separate_to_combined_map(
+    const array_ref&          records,
+    const array_ref&          ids,
+    blob_reader&              reader,
+    separate_to_combined_map& map) noexcept {
+  using record                            = separate_to_combined_map::record;
+  const const_span<record>   map_records  = reader.get<record>(records);
+  const const_span<uint32_t> combined_ids = reader.get<uint32_t>(ids);
+  if (reader.failed()) { return false; }
+  for (const record& r : map_records) {
+    if (r.first_combined_id > combined_ids.size() ||
+        r.combined_id_count > combined_ids.size() - r.first_combined_id) {
+      return false;
+    }
+  }
+  map.records_.assign(map_records.begin(), map_records.end());
+  map.combined_ids_.assign(combined_ids.begin(), combined_ids.end());
+  return true;
+}
+
+value_or_error<compiled_techniques> technique_serializer::read(
+    const_span<std::byte>       data,
+    std::shared_ptr<const void> owner,
+    std::pmr::memory_resource*  resource) noexcept {
+  static_assert(std::is_trivially_copyable_v<pipeline_layout::set_range>);
+  static_assert(std::is_trivially_copyable_v<pipeline_layout::block_range>);
+  static_assert(std::is_trivially_copyable_v<separate_to_combined_map::record>);
+
+  // Shader code in the results points into the data, so it has to be kept alive and suitably
+  // aligned. If the caller can't guarantee that, make a single copy that all results share.
+  if (owner == nullptr || (uintptr_t)data.data() % section_alignment != 0u) {
+    auto copy = std::make_shared<std::vector<uint64_t>>((data.size() + 7u) / 8u);
+    if (data.size() > 0u) { memcpy(copy->data(), data.data(), data.size()); }
+    data  = const_span<std::byte> {reinterpret_cast<const std::byte*>(copy->data()), data.size()};
+    owner = std::move(copy);
+  }
+
+  file_header header;
+  if (data.size() < sizeof(header)) {
+    NICESHADE_RETURN_ERROR("serialized techniques are truncated");
+  }
+  memcpy(&header, data.data(), sizeof(header));
+  if (memcmp(header.magic, serialized_magic, sizeof(header.magic)) != 0) {
+    NICESHADE_RETURN_ERROR("data does not contain serialized techniques");
+  }
+  if (header.byte_order != byte_order_marker) {
+    NICESHADE_RETURN_ERROR("serialized techniques were written with a different byte order");
+  }
+  if (header.version != serialized_techniques_version) {
+    NICESHADE_RETURN_ERROR(
+        "unsupported serialized techniques version ",
+        header.version,
+        " (expected ",
+        serialized_techniques_version,
+        ")");
+  }
+  if (header.total_size > data.size()) {
+    NICESHADE_RETURN_ERROR("serialized techniques are truncated");
+  }
+
+  blob_reader reader {const_span<std::byte> {data.data(), (size_t)header.total_size}};
+  const const_span<string_record>    string_records = reader.get<string_record>(header.strings);
+  const const_span<char>             string_data    = reader.get<char>(header.string_data);
+  const const_span<technique_record> tech_records = reader.get<technique_record>(header.techniques);
+  if (reader.failed()) { NICESHADE_RETURN_ERROR("serialized techniques are malformed"); }
+
+  // All loaded techniques share one string pool, like the results of a single compile call. The
+  // names are not copied into it: they refer to the string table, which the pool keeps alive.
+  auto strings = std::allocate_shared<string_pool>(arena_allocator<string_pool> {resource}, resource);
+  strings->retain(owner);
+  std::vector<std::string_view> names;
+  names.reserve(string_records.size());
+  for (const string_record& s : string_records) {
+    if (s.offset > string_data.size() || s.size >= string_data.size() - s.offset ||
+        string_data[s.offset + s.size] != '\0') {
+      NICESHADE_RETURN_ERROR("serialized techniques are malformed");
+    }
+    names.emplace_back(string_data.data() + s.offset, s.size);
+  }
+
+  compiled_techniques result {resource};
+  result.reserve(tech_records.size());
+  for (const technique_record& rec : tech_records) {
+    compiled_technique& tech = result.emplace_back(resource);
+    bool valid = rec.name < names.size();
+    if (valid) { tech.name = std::string {names[rec.name]}; }
+
+    tech.layout      = pipeline_layout {resource};
+    tech.image_map   = separate_to_combined_map {resource};
+    tech.sampler_map = separate_to_combined_map {resource};
+    tech.spec_consts = spec_const_layout {resource};
+    valid            = valid && read_layout(rec, reader, names, tech.layout) &&
+            read_separate_to_combined_map(
+                rec.image_map_records,
+                rec.image_map_ids,
+                reader,
+                tech.image_map) &&
+            read_separate_to_combined_map(
+                rec.sampler_map_records,
+                rec.sampler_map_ids,
+                reader,
+                tech.sampler_map);
+    if (!valid) { NICESHADE_RETURN_ERROR("serialized techniques are malformed"); }
+
+    for (const spec_const_record& sc : reader.get<spec_const_record>(rec.spec_consts)) {
+      if (sc.name >= names.size()) { reader.fail(); break; }
+      tech.spec_consts.emplace(names[sc.name], spec_const {sc.id, sc.type_id});
+    }
+
+    auto read_vars = [&](const array_ref& ref, arena_vector<interface_variable>& vars) {
+      const const_span<interface_variable_record> records =
+          reader.get<interface_variable_record>(ref);
+      vars.reserve(records.size());
+      for (const interface_variable_record& v : records) {
+        if (v.name >= names.size() || v.base_type >= interface_variable::TypeCount) {
+          reader.fail();
+          return;
+        }
+        vars.push_back(interface_variable {
+            names[v.name],
+            (interface_variable::type)v.base_type,
+            v.vecsize,
+            v.location_decoration});
+      }
+    };
+    const const_span<interface_record> interfaces = reader.get<interface_record>(rec.interfaces);
+    tech.per_stage_interface.reserve(interfaces.size());
+    for (const interface_record& iface : interfaces) {
+      if (iface.stage > (uint32_t)pipeline_stage::compute) { reader.fail(); break; }
+      interface_variables& vars = tech.per_stage_interface.emplace_back(interface_variables {
+          (pipeline_stage)iface.stage,
+          arena_vector<interface_variable> {resource},
+          arena_vector<interface_variable> {resource}});
+      read_vars(iface.input_vars, vars.input_vars);
+      read_vars(iface.output_vars, vars.output_vars);
+    }
+
+    const const_span<targeted_output_record> outputs =
+        reader.get<targeted_output_record>(rec.targeted_outputs);
+    tech.targeted_outputs.reserve(outputs.size());
+    for (const targeted_output_record& out : outputs) {
+      if (out.api > (uint32_t)target_api::VULKAN ||
+          out.platform > (uint32_t)target_platform_class::MOBILE) {
+        reader.fail();
+        break;
+      }
+      targeted_output& target_out = tech.targeted_outputs.emplace_back(resource);
+      target_out.target           = target_desc {
+          (target_api)out.api,
+          out.version_maj,
+          out.version_min,
+          (target_platform_class)out.platform};
+      const const_span<stage_record> stages = reader.get<stage_record>(out.stages);
+      target_out.stages.reserve(stages.size());
+      for (const stage_record& s : stages) {
+        if (s.stage > (uint32_t)pipeline_stage::compute) { reader.fail(); break; }
+        compiled_stage& stage = target_out.stages.emplace_back();
+        stage.stage           = (pipeline_stage)s.stage;
+        stage.result          = compilation_result {reader.get<std::byte>(s.code), owner};
+        if (s.has_threadgroup_size) {
+          stage.threadgroup_size = std::array<uint32_t, 3> {
+              s.threadgroup_size[0],
+              s.threadgroup_size[1],
+              s.threadgroup_size[2]};
+        }
+        stage.stats.codegen_passes       = s.codegen_passes;
+        stage.stats.stripped_debug_bytes = s.stripped_debug_bytes;
+      }
+    }
+    tech.strings = strings;
+    if (reader.failed()) { NICESHADE_RETURN_ERROR("serialized techniques are malformed"); }
+  }
+  return result;
+}
+
+std::vector<std::byte> serialize_techniques(const compiled_techniques& techniques) {
+  return technique_serializer::write(techniques);
+}
+
+value_or_error<compiled_techniques> deserialize_techniques(
+    const_span<std::byte>       data,
+    std::shared_ptr<const void> owner,
+    std::pmr::memory_resource*  resource) noexcept {
+  return technique_serializer::read(data, std::move(owner), resource);
+}
+
+}  // namespace niceshade
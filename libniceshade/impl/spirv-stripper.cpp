@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "impl/spirv-stripper.h"
+
+#include "spirv.hpp"
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+namespace niceshade {
+
+namespace {
+
+constexpr size_t spirv_header_words = 5u;
+
+bool is_debug_opcode(uint32_t opcode) noexcept {
+  switch (opcode) {
+  case spv::OpSourceContinued:
+  case spv::OpSource:
+  case spv::OpSourceExtension:
+  case spv::OpName:
+  case spv::OpMemberName:
+  case spv::OpString:
+  case spv::OpLine:
+  case spv::OpNoLine:
+  case spv::OpModuleProcessed: return true;
+  default: return false;
+  }
+}
+
+// Checks whether the literal string starting at the given operand of an instruction begins with
+// the given prefix.
+bool literal_starts_with(const uint32_t* operands, size_t operand_count, const char* prefix) {
+  const size_t prefix_length = strlen(prefix);
+  return operand_count * sizeof(uint32_t) >= prefix_length &&
+         memcmp(operands, prefix, prefix_length) == 0;
+}
+
+}  // namespace
+
+shared_spirv_blob strip_debug_instructions(const shared_spirv_blob& spirv) noexcept {
+  const const_span<uint32_t>& words = spirv.words;
+  if (words.size() < spirv_header_words || words[0] != spv::MagicNumber) { return spirv; }
+
+  // Non-semantic extended instruction sets can be removed along with all of their instructions,
+  // which may only be used by other non-semantic instructions.
+  std::vector<uint32_t> non_semantic_sets;
+  for (size_t i = spirv_header_words; i < words.size();) {
+    const uint32_t opcode = words[i] & spv::OpCodeMask;
+    const uint32_t length = words[i] >> spv::WordCountShift;
+    if (length == 0u || length > words.size() - i) { return spirv; }
+    if (opcode == spv::OpExtInstImport && length > 2u &&
+        literal_starts_with(&words[i + 2u], length - 2u, "NonSemantic.")) {
+      non_semantic_sets.push_back(words[i + 1u]);
+    }
+    i += length;
+  }
+
+  auto stripped = std::make_shared<std::vector<uint32_t>>();
+  stripped->reserve(words.size());
+  stripped->insert(stripped->end(), words.begin(), words.begin() + spirv_header_words);
+  for (size_t i = spirv_header_words; i < words.size();) {
+    const uint32_t opcode = words[i] & spv::OpCodeMask;
+    const uint32_t length = words[i] >> spv::WordCountShift;
+    const auto     is_non_semantic_set = [&non_semantic_sets](uint32_t id) {
+      return std::find(non_semantic_sets.begin(), non_semantic_sets.end(), id) !=
+             non_semantic_sets.end();
+    };
+    const bool strip =
+        is_debug_opcode(opcode) ||
+        (opcode == spv::OpExtInstImport && length > 2u && is_non_semantic_set(words[i + 1u])) ||
+        (opcode == spv::OpExtInst && length > 3u && is_non_semantic_set(words[i + 3u])) ||
+        (opcode == spv::OpExtension && !non_semantic_sets.empty() && length > 1u &&
+         literal_starts_with(&words[i + 1u], length - 1u, "SPV_KHR_non_semantic_info"));
+    if (!strip) { stripped->insert(stripped->end(), &words[i], &words[i] + length); }
+    i += length;
+  }
+  if (stripped->size() == words.size()) { return spirv; }
+
+  const const_span<uint32_t> stripped_words {stripped->data(), stripped->size()};
+  return shared_spirv_blob {stripped_words, std::move(stripped)};
+}
+
+}  // namespace niceshade
@@ -24,11 +24,14 @@
 
 #include "impl/error-macros.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <ctype.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <string_view>
 
 namespace niceshade {
 
@@ -48,75 +51,137 @@ enum class technique_parser_state {
 namespace {
 bool           is_ident(char c) { return (isalnum(c) || c == '_'); }
 constexpr bool is_tab_space(char c) { return (c == ' ' || c == '\t'); }
+
+constexpr size_t no_prefix = ~(size_t)0u;
+
+// Returns the number of the line that the given position is on. Line numbers are only needed for
+// error messages, so they are computed on demand instead of being tracked while scanning.
+uint32_t line_number(const char* text, size_t pos) noexcept {
+  return 1u + (uint32_t)std::count(text, text + pos, '\n');
+}
+
+// Returns the position of the first carriage return that isn't followed by a line feed, or `size`
+// if there is none. The end of the input counts as a line feed.
+size_t find_stray_cr(const char* text, size_t size) noexcept {
+  const char* end = text + size;
+  for (const char* p = text; (p = (const char*)memchr(p, '\r', (size_t)(end - p))) != nullptr;
+       ++p) {
+    if (p + 1 != end && p[1] != '\n') { return (size_t)(p - text); }
+  }
+  return size;
+}
+
+// Returns the position right after the first technique prefix (`//T:', possibly with spaces or
+// tabs in between the characters) that ends in the [pos, end) range, or `no_prefix` if there is
+// none. Candidate colons are located with memchr, which C libraries implement with SIMD, and then
+// checked by looking backwards, so the bulk of the input is never examined byte-by-byte.
+size_t find_technique_prefix(const char* text, size_t pos, size_t end) noexcept {
+  static constexpr char prefix[] = {'/', '/', 'T'};
+  while (pos < end) {
+    const char* colon = (const char*)memchr(text + pos, ':', end - pos);
+    if (colon == nullptr) { break; }
+    const size_t colon_pos = (size_t)(colon - text);
+    int          matched   = 3;
+    for (size_t i = colon_pos; i > 0u && matched > 0; --i) {
+      const char c = text[i - 1u];
+      // Carriage returns before this point are always part of a CRLF sequence.
+      if (is_tab_space(c) || c == '\r') { continue; }
+      if (c != prefix[matched - 1]) { break; }
+      --matched;
+    }
+    if (matched == 0) { return colon_pos + 1u; }
+    pos = colon_pos + 1u;
+  }
+  return no_prefix;
+}
 }  // namespace
 
 value_or_error<std::vector<technique_desc>>
 parse_techniques(input_blob input_source, const define_container& default_defines) noexcept {
-  uint32_t                    last_four_chars  = 0u;
-  uint32_t                    line_num         = 1u;
-  const uint32_t              technique_prefix = 0x2f2f543a;  // `//T:'
-  technique_parser_state      state            = technique_parser_state::LOOKING_FOR_PREFIX;
-  std::string                 parameter_name, entry_point_name, nameval_name, nameval_value;
+  const char*                 text = reinterpret_cast<const char*>(input_source.data());
+  const size_t                size = input_source.size();
+  const size_t                first_stray_cr = find_stray_cr(text, size);
+  technique_parser_state      state          = technique_parser_state::LOOKING_FOR_PREFIX;
+  size_t                      token_begin    = 0u;
+  std::string_view            parameter_name, entry_point_name, nameval_name, nameval_value;
   bool                        have_vertex_or_compute_stage = false;
   std::vector<technique_desc> techniques;
-  for (uint32_t c_idx = 0u; c_idx < input_source.size(); ++c_idx) {
-    const char c = static_cast<char>(input_source[c_idx]);
+  // All techniques refer to a single copy of the default definitions.
+  const auto shared_defines =
+      default_defines.empty() ? nullptr : std::make_shared<const define_container>(default_defines);
+
+  // Tokens are views into the input, and only get copied into strings once complete. A token never
+  // contains a carriage return, but one may precede the line feed that terminates it.
+  auto token = [&](size_t token_end) {
+    if (token_end > token_begin && text[token_end - 1u] == '\r') { --token_end; }
+    return std::string_view {text + token_begin, token_end - token_begin};
+  };
+
+  // The input does not need to end with a line feed: the end of the input is processed as if it
+  // were one, so a technique declared on the last line is terminated properly.
+  for (size_t c_idx = 0u; c_idx <= size; ++c_idx) {
+    if (state == technique_parser_state::LOOKING_FOR_PREFIX) {
+      // Skip directly to the character following the next technique prefix.
+      const size_t prefix_end = find_technique_prefix(text, c_idx, first_stray_cr);
+      if (prefix_end == no_prefix) {
+        if (first_stray_cr < size) {
+          NICESHADE_RETURN_ERROR(
+              "Stray carriage return in input on line %d\n",
+              line_number(text, first_stray_cr));
+        }
+        break;
+      }
+      state = technique_parser_state::LOOKING_FOR_NAME;
+      techniques.emplace_back();
+      techniques.back().shared_defines = shared_defines;
+      have_vertex_or_compute_stage     = false;
+      c_idx                            = prefix_end;
+    }
+    const char c = c_idx < size ? text[c_idx] : '\n';
     // Collapse windows line endings into '\n'.
-    if (c == '\r' && (c_idx == input_source.size() - 1u ||
-                      static_cast<char>(input_source[c_idx + 1u]) != '\n')) {
-      NICESHADE_RETURN_ERROR("Stray carriage return in input on line %d\n", line_num);
+    if (c == '\r' && c_idx + 1u < size && text[c_idx + 1u] != '\n') {
+      NICESHADE_RETURN_ERROR(
+          "Stray carriage return in input on line %d\n",
+          line_number(text, c_idx));
     } else if (c == '\r') {
       continue;
     }
-    if (!is_tab_space(c)) {
-      last_four_chars <<= 8u;
-      last_four_chars |= (uint32_t)c;
-    }
     switch (state) {
     case technique_parser_state::LOOKING_FOR_PREFIX:
-      if (last_four_chars == technique_prefix) {
-        state = technique_parser_state::LOOKING_FOR_NAME;
-        techniques.emplace_back();
-        technique_desc& new_tech = techniques.back();
-        new_tech.defines.insert(
-            new_tech.defines.end(),
-            default_defines.begin(),
-            default_defines.end());
-        have_vertex_or_compute_stage = false;
-      }
+      // Handled by the fast path above.
       break;
     case technique_parser_state::LOOKING_FOR_NAME:
       if (is_ident(c)) {
-        state = technique_parser_state::PARSING_NAME;
-        techniques.back().name.push_back(c);
+        state       = technique_parser_state::PARSING_NAME;
+        token_begin = c_idx;
       } else if (!is_tab_space(c)) {
         NICESHADE_RETURN_ERROR(
             "unexpected character ",
             c,
             " in technique name ",
             "on line ",
-            line_num);
+            line_number(text, c_idx));
       }
       break;
     case technique_parser_state::PARSING_NAME:
       if (is_ident(c) || c == '-') {
-        techniques.back().name.push_back(c);
+        // Keep scanning the name.
       } else if (is_tab_space(c)) {
-        state = technique_parser_state::LOOKING_FOR_PARAMETER_NAME;
+        techniques.back().name = token(c_idx);
+        state                  = technique_parser_state::LOOKING_FOR_PARAMETER_NAME;
       } else {
         NICESHADE_RETURN_ERROR(
             "unexpected character ",
             c,
             " in technique name ",
             "on line ",
-            line_num);
+            line_number(text, c_idx));
       }
       break;
     case technique_parser_state::LOOKING_FOR_PARAMETER_NAME:
       if (is_ident(c)) {
-        state = technique_parser_state::PARSING_PARAMETER_NAME;
-        parameter_name.clear();
-        parameter_name.push_back(c);
+        state       = technique_parser_state::PARSING_PARAMETER_NAME;
+        token_begin = c_idx;
       } else if (c == '\n') {
         state = technique_parser_state::FINALIZING_TECHNIQUE;
       } else if (!is_tab_space(c)) {
@@ -125,25 +190,25 @@ parse_techniques(input_blob input_source, const define_container& default_define
             c,
             " in technique param name ",
             "on line ",
-            line_num);
+            line_number(text, c_idx));
       }
       break;
     case technique_parser_state::PARSING_PARAMETER_NAME:
       if (is_ident(c)) {
-        parameter_name.push_back(c);
+        // Keep scanning the parameter name.
       } else if (c == ':') {
+        parameter_name = token(c_idx);
+        token_begin    = c_idx + 1u;
         if (parameter_name == "define" || parameter_name == "meta") {
           state = technique_parser_state::PARSING_NAMEVAL_NAME;
-          nameval_name.clear();
         } else if (parameter_name == "vs" || parameter_name == "ps" || parameter_name == "cs") {
           state = technique_parser_state::PARSING_ENTRYPOINT_NAME;
-          entry_point_name.clear();
         } else {
           NICESHADE_RETURN_ERROR(
               "unknown parameter ",
-              parameter_name.c_str(),
+              parameter_name,
               " on line ",
-              line_num);
+              line_number(text, c_idx));
         }
       } else {
         NICESHADE_RETURN_ERROR(
@@ -151,21 +216,24 @@ parse_techniques(input_blob input_source, const define_container& default_define
             c,
             " in technique param name ",
             "on line ",
-            line_num);
+            line_number(text, c_idx));
       }
       break;
     case technique_parser_state::PARSING_ENTRYPOINT_NAME:
       if (is_ident(c)) {
-        entry_point_name.push_back(c);
+        // Keep scanning the entry point name.
       } else if (is_tab_space(c) || c == '\n') {
+        entry_point_name = token(c_idx);
         if (entry_point_name.empty()) {
-          NICESHADE_RETURN_ERROR("entry point name cannot be empty on line ", line_num);
+          NICESHADE_RETURN_ERROR(
+              "entry point name cannot be empty on line ",
+              line_number(text, c_idx));
         }
         technique_desc::entry_point ep {
             parameter_name == "vs"
                 ? pipeline_stage::vertex
                 : (parameter_name == "ps" ? pipeline_stage::fragment : pipeline_stage::compute),
-            entry_point_name};
+            std::string {entry_point_name}};
 
         for (const auto& prev_ep : techniques.back().entry_points) {
           if (ep.stage == pipeline_stage::compute) {
@@ -176,14 +244,14 @@ parse_techniques(input_blob input_source, const define_container& default_define
           if (prev_ep.stage == ep.stage) {
             NICESHADE_RETURN_ERROR(
                 "duplicate entry point ",
-                parameter_name.c_str(),
+                parameter_name,
                 ":",
                 ep.name.c_str(),
                 " on line ",
-                line_num);
+                line_number(text, c_idx));
           }
         }
-        techniques.back().entry_points.emplace_back(ep);
+        techniques.back().entry_points.emplace_back(std::move(ep));
         have_vertex_or_compute_stage |= (parameter_name == "vs" || parameter_name == "cs");
         state = c != '\n' ? technique_parser_state::LOOKING_FOR_PARAMETER_NAME
                           : technique_parser_state::FINALIZING_TECHNIQUE;
@@ -192,27 +260,29 @@ parse_techniques(input_blob input_source, const define_container& default_define
             "unexpected character ",
             c,
             " in entry point name on line ",
-            line_num);
+            line_number(text, c_idx));
       }
       break;
     case technique_parser_state::PARSING_NAMEVAL_NAME:
       if (is_ident(c)) {
-        nameval_name.push_back(c);
+        // Keep scanning the name.
       } else if (c == '=') {
-        state = technique_parser_state::PARSING_NAMEVAL_VALUE;
-        nameval_value.clear();
+        nameval_name = token(c_idx);
+        token_begin  = c_idx + 1u;
+        state        = technique_parser_state::PARSING_NAMEVAL_VALUE;
       } else {
         NICESHADE_RETURN_ERROR(
             "unexpected character ",
             c,
             " in definition name on line ",
-            line_num);
+            line_number(text, c_idx));
       }
       break;
     case technique_parser_state::PARSING_NAMEVAL_VALUE:
       if (!is_tab_space(c) && c != '\n') {
-        nameval_value.push_back(c);
+        // Keep scanning the value.
       } else {
+        nameval_value = token(c_idx);
         if (parameter_name == "define") {
           techniques.back().defines.emplace_back(nameval_name, nameval_value);
         } else if (parameter_name == "meta") {
@@ -228,12 +298,16 @@ parse_techniques(input_blob input_source, const define_container& default_define
       if (!have_vertex_or_compute_stage) {
         NICESHADE_RETURN_ERROR(
             "technique needs to define at least a vertex or compute stage on line ",
-            line_num);
+            line_number(text, c_idx));
       }
       state = technique_parser_state::LOOKING_FOR_PREFIX;
       break;
     }
-    if (c == '\n') ++line_num;
+  }
+  if (state == technique_parser_state::FINALIZING_TECHNIQUE && !have_vertex_or_compute_stage) {
+    NICESHADE_RETURN_ERROR(
+        "technique needs to define at least a vertex or compute stage on line ",
+        line_number(text, size));
   }
   return techniques;
 }
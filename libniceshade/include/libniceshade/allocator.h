@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <memory_resource>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @file
+ * @brief
+ */
+
+namespace niceshade {
+
+/**
+ * An allocator that obtains memory from a `std::pmr::memory_resource`. Unlike
+ * `std::pmr::polymorphic_allocator`, it travels with the data it allocated: moving or swapping a
+ * container that uses it moves the memory resource along, so results built inside an arena can be
+ * moved around without being copied out of it. Copies of a container use the default memory
+ * resource.
+ *
+ * Containers in niceshade output types use this allocator, so that the output produced by a call
+ * to \ref instance::compile can be placed in a caller-supplied memory resource (for example, a
+ * `std::pmr::monotonic_buffer_resource`) and released all at once.
+ */
+template<class T> class arena_allocator {
+public:
+  using value_type                             = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap            = std::true_type;
+
+  arena_allocator() noexcept : resource_ {std::pmr::get_default_resource()} {}
+  arena_allocator(std::pmr::memory_resource* resource) noexcept : resource_ {resource} {}
+  template<class U>
+  arena_allocator(const arena_allocator<U>& other) noexcept : resource_ {other.resource()} {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* ptr, size_t n) noexcept {
+    resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+  }
+
+  arena_allocator select_on_container_copy_construction() const noexcept {
+    return arena_allocator {};
+  }
+
+  /** @return The memory resource that this allocator obtains memory from. */
+  std::pmr::memory_resource* resource() const noexcept { return resource_; }
+
+  template<class U> bool operator==(const arena_allocator<U>& other) const noexcept {
+    return resource_ == other.resource() || resource_->is_equal(*other.resource());
+  }
+  template<class U> bool operator!=(const arena_allocator<U>& other) const noexcept {
+    return !(*this == other);
+  }
+
+private:
+  std::pmr::memory_resource* resource_;
+};
+
+/** A vector that allocates its storage through an \ref arena_allocator. */
+template<class T> using arena_vector = std::vector<T, arena_allocator<T>>;
+
+}  // namespace niceshade
@@ -25,6 +25,8 @@
 #include "libniceshade/span.h"
 
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -61,6 +63,15 @@ using define_container = std::vector<std::pair<std::string, std::string>>;
  */
 using spirv_blob = std::vector<uint32_t>;
 
+/**
+ * A read-only view of SPIR-V code that shares ownership of the memory backing it. All outputs that
+ * contain the same SPIR-V refer to a single copy of it.
+ */
+struct shared_spirv_blob {
+  const_span<uint32_t>        words; /**< The SPIR-V code. */
+  std::shared_ptr<const void> owner; /**< Keeps the memory that `words` points into alive. */
+};
+
 /**
  * A span of memory containing HLSL code to be processed by niceshade.
  */
@@ -72,4 +83,30 @@ using input_blob = const_span<std::byte>;
  */
 using hlsl_diagnostic_callback = void (*)(const char*, size_t);
 
+/**
+ * Include resolver callback. It receives the path of a file requested by an HLSL `#include`
+ * directive, as spelled by the HLSL compiler (i.e. already combined with the including file's
+ * folder or an include search path). If the callback can supply the file's contents, it should
+ * point the second argument to them and return true. Otherwise, it should return false, and the
+ * file is looked up on the filesystem instead. The contents are used in place rather than copied,
+ * so they must stay valid until the compile call that requested them returns.
+ */
+using hlsl_include_resolver = std::function<bool(const char*, input_blob&)>;
+
+/**
+ * Counts of how the files requested by HLSL `#include` directives were served, see
+ * \ref instance::include_statistics. A file included by several entry points or techniques is
+ * counted once per request.
+ */
+struct include_stats {
+  /** Requests served by the \ref hlsl_include_resolver. */
+  uint32_t resolved = 0u;
+
+  /** Requests for which the file was read from disk, including reloads of files that changed. */
+  uint32_t loaded = 0u;
+
+  /** Requests served from the include cache, without reading the file again. */
+  uint32_t cache_hits = 0u;
+};
+
 }  // namespace niceshade
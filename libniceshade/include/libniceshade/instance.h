@@ -28,6 +28,7 @@
 #include "libniceshade/span.h"
 #include "libniceshade/target.h"
 
+#include <memory_resource>
 #include <stdint.h>
 #include <string>
 #include <vector>
@@ -79,6 +80,47 @@ public:
      * and the generated pipeline layout, even if the bindings are not used by the shader.
      */
     bool preserve_bindings = false;
+
+    /**
+     * If nonzero, a warning shall be delivered via `diagnostic_message_callback` for every pipeline
+     * stage that takes SPIRV-Cross more than this many code generation passes to produce.
+     * See \ref stage_stats::codegen_passes.
+     */
+    uint32_t codegen_pass_warning_threshold = 0u;
+
+    /**
+     * Setting this to true makes techniques with more than one entry point get compiled by a
+     * single DXC invocation using a library target profile (`lib_<shader_model>`), instead of
+     * one invocation per entry point. All stages of the technique then share the resulting
+     * SPIR-V module. Entry points must be marked with a `[shader("<stage>")]` attribute, and the
+     * shader model must support library targets with the stages in use.
+     */
+    bool compile_techniques_as_libraries = false;
+
+    /**
+     * Setting this to true skips cross-compilation: \ref instance::compile stops after generating
+     * SPIR-V and building the layouts. The pipeline layout, specialization constants,
+     * separate-to-combined maps and interface variables are produced as usual, and each targeted
+     * output still lists its stages (with threadgroup sizes for compute shaders), but the stages'
+     * \ref compiled_stage::result is left empty. Useful for tools that only need reflection
+     * data.
+     */
+    bool reflection_only = false;
+
+    /**
+     * If set, this function is consulted for the contents of every file requested by an HLSL
+     * `#include` directive before the filesystem is searched. This allows serving headers straight
+     * from memory (for example, from a packed asset archive). See \ref hlsl_include_resolver.
+     */
+    hlsl_include_resolver include_resolver;
+
+    /**
+     * Setting this to true removes debug instructions (names, source and line information, and
+     * non-semantic extended instructions) from SPIR-V output. Stripping happens after reflection,
+     * so the pipeline layout, interface variables and everything else derived from the names is
+     * unaffected. See \ref stage_stats::stripped_debug_bytes.
+     */
+    bool strip_debug_info = false;
   };
 
   /**
@@ -95,9 +137,14 @@ public:
   instance& operator=(const instance&) = delete;
   instance(instance&& other) noexcept { *this = std::move(other); }
   instance& operator=(instance&& other) noexcept {
-    dxc_       = other.dxc_;
-    other.dxc_ = nullptr;
-    preserve_bindings_ = other.preserve_bindings_;
+    dxc_                             = other.dxc_;
+    other.dxc_                       = nullptr;
+    preserve_bindings_               = other.preserve_bindings_;
+    diag_callback_                   = other.diag_callback_;
+    codegen_pass_warning_threshold_  = other.codegen_pass_warning_threshold_;
+    compile_techniques_as_libraries_ = other.compile_techniques_as_libraries_;
+    reflection_only_                 = other.reflection_only_;
+    strip_debug_info_                = other.strip_debug_info_;
     return *this;
   }
 
@@ -109,27 +156,65 @@ public:
    * for this to be correct for HLSL `#include` directives to work properly.
    * @param targets A list of descriptions of targets to generate shaders for.
    * @param global_defines A list of additional preprocessor definitions to add during compilation.
+   * @param resource The memory resource to use for compilation, see \ref compile.
    * @return \ref descs_and_compiled_techniques
    */
   value_or_error<descs_and_compiled_techniques> parse_techniques_and_compile(
-      input_blob              in_blob,
-      const char*             file_name,
-      const_span<target_desc> targets,
-      const define_container& global_defines) noexcept;
+      input_blob                 in_blob,
+      const char*                file_name,
+      const_span<target_desc>    targets,
+      const define_container&    global_defines,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept;
+
+  /**
+   * Same as \ref parse_techniques_and_compile, but reads the source HLSL from a file. The file is
+   * mapped into memory rather than copied, and is unmapped before returning.
+   *
+   * @param file_path Path to the file containing the source HLSL. It is also used to resolve
+   * HLSL `#include` directives.
+   * @param targets A list of descriptions of targets to generate shaders for.
+   * @param global_defines A list of additional preprocessor definitions to add during compilation.
+   * @param resource The memory resource to use for compilation, see \ref compile.
+   * @return \ref descs_and_compiled_techniques
+   */
+  value_or_error<descs_and_compiled_techniques> parse_techniques_and_compile_file(
+      const char*                file_path,
+      const_span<target_desc>    targets,
+      const define_container&    global_defines,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept;
 
   /**
    * Compiles several \ref compiler_input units at a time. Note that any techniques defined inline
    * in the HLSL code are ignored.
    * @param compiler_inputs A sequence of compiler inputs to process.
    * @param targets A sequence of descriptions of targets to generate output for.
+   * @param resource The memory resource that intermediate data and the returned
+   * \ref compiled_techniques (including their layouts, interface variables and interned names) are
+   * allocated from. Passing an arena such as `std::pmr::monotonic_buffer_resource` allows releasing
+   * everything at once; the results must then not outlive the arena. Technique names, generated
+   * shader code and SPIR-V are not allocated from this resource, so the buffers returned by
+   * \ref compilation_result::storage may be kept after the arena is released.
    * @return \ref compiled_techniques
    */
-  value_or_error<compiled_techniques>
-  compile(const_span<compiler_input> compiler_inputs, const_span<target_desc> targets) noexcept;
+  value_or_error<compiled_techniques> compile(
+      const_span<compiler_input> compiler_inputs,
+      const_span<target_desc>    targets,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept;
+
+  /**
+   * @return How the files requested by HLSL `#include` directives have been served so far, across
+   * all compile calls made with this instance.
+   */
+  include_stats include_statistics() const noexcept;
 
 private:
-  dxc_wrapper* dxc_;
-  bool         preserve_bindings_ = false;
+  dxc_wrapper*             dxc_;
+  bool                     preserve_bindings_               = false;
+  hlsl_diagnostic_callback diag_callback_                   = nullptr;
+  uint32_t                 codegen_pass_warning_threshold_  = 0u;
+  bool                     compile_techniques_as_libraries_ = false;
+  bool                     reflection_only_                 = false;
+  bool                     strip_debug_info_                = false;
 };
 
 }  // namespace niceshade
\ No newline at end of file
@@ -162,6 +162,16 @@
  * Note that passing in the correct file name is important if your HLSL code contains `#include`
  * directives.
  *
+ * If your HLSL lives in a file, \ref niceshade::instance::parse_techniques_and_compile_file takes the
+ * file's path instead, and maps the file into memory rather than copying its contents:
+ *
+ * ```
+ * auto maybe_results = ns_instance.parse_techniques_and_compile_file(
+ *   "your_file_name.hlsl",
+ *    niceshade::const_span<target_desc> {targets.data(), targets.size()},
+ *    additional_definitions);
+ * ```
+ *
  * The value returned by the method shall contain an error message if compiling the HLSL code fails:
  *
  * ```
@@ -176,6 +186,19 @@
  * corresponding \ref niceshade::compiled_technique objects containing the shader code for each
  * requested target, as well as information about resources consumed by the shader (\ref
  * niceshade::pipeline_layout), and other metadata.
+ *
+ * \subsubsection caching Caching Compiled Techniques
+ *
+ * Compiled techniques can be saved with \ref niceshade::serialize_techniques and loaded back with
+ * \ref niceshade::deserialize_techniques, without recompiling or re-reflecting anything:
+ *
+ * ```
+ * std::vector<std::byte> blob = niceshade::serialize_techniques(compiled_techs);
+ * // ...write the blob to a file, and later read or map it back...
+ * auto maybe_techs = niceshade::deserialize_techniques(
+ *    niceshade::const_span<std::byte> {blob.data(), blob.size()});
+ * ```
  */
 
-#include "libniceshade/instance.h"
\ No newline at end of file
+#include "libniceshade/instance.h"
+#include "libniceshade/serialization.h"
\ No newline at end of file
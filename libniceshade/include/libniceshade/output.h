@@ -22,18 +22,22 @@
 
 #pragma once
 
+#include "libniceshade/allocator.h"
 #include "libniceshade/common-types.h"
 #include "libniceshade/pipeline-layout.h"
 #include "libniceshade/spec-const-layout.h"
 #include "libniceshade/separate-to-combined-map.h"
 #include "libniceshade/span.h"
+#include "libniceshade/string-pool.h"
 #include "libniceshade/target.h"
 #include "libniceshade/technique.h"
 
 #include <array>
+#include <memory>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <tuple>
-#include <variant>
 #include <vector>
 
 /**
@@ -48,35 +52,65 @@ namespace niceshade {
  */
 class compilation_result {
   friend class compilation;
+  friend class technique_serializer;
 
 public:
-  compilation_result()                     = default;
-  compilation_result(compilation_result&&) = default;
+  compilation_result()                          = default;
+  compilation_result(const compilation_result&) = default;
+  compilation_result(compilation_result&&)      = default;
+  compilation_result& operator=(const compilation_result&) = default;
   compilation_result& operator=(compilation_result&&) = default;
 
   /**
    * A span of memory containing raw output bytes (GLSL, Metal Shading Language, or SPIR-V...).
    */
-  const_span<std::byte> data() const noexcept {
-    if (std::holds_alternative<spirv_blob>(result_)) {
-      const spirv_blob& blob = std::get<spirv_blob>(result_);
-      return const_span<std::byte> {
-          reinterpret_cast<const std::byte*>(blob.data()),
-          blob.size() * sizeof(uint32_t)};
-    } else {
-      const std::string& str = std::get<std::string>(result_);
-      return const_span<std::byte> {reinterpret_cast<const std::byte*>(str.data()), str.size()};
-    }
-  }
+  const_span<std::byte> data() const noexcept { return data_; }
+
+  /**
+   * The reference-counted buffer that \ref data points into. The buffer is immutable and may be
+   * shared with other results, so keeping a copy of this pointer (e.g. in a cache) keeps the output
+   * alive without copying it.
+   */
+  const std::shared_ptr<const void>& storage() const noexcept { return storage_; }
 
 private:
-  explicit compilation_result(const spirv_blob& blob) noexcept {
-    result_.emplace<spirv_blob>(blob);
+  explicit compilation_result(const shared_spirv_blob& blob) noexcept
+      : data_ {reinterpret_cast<const std::byte*>(blob.words.data()),
+               blob.words.size() * sizeof(uint32_t)},
+        storage_ {blob.owner} {
+  }
+  compilation_result(const_span<std::byte> data, std::shared_ptr<const void> storage) noexcept
+      : data_ {data},
+        storage_ {std::move(storage)} {
   }
-  explicit compilation_result(std::string&& str) noexcept {
-    result_.emplace<std::string>(std::move(str));
+  explicit compilation_result(std::string&& str) {
+    auto shared_str = std::make_shared<const std::string>(std::move(str));
+    data_ = const_span<std::byte> {
+        reinterpret_cast<const std::byte*>(shared_str->data()),
+        shared_str->size()};
+    storage_ = std::move(shared_str);
   }
-  std::variant<spirv_blob, std::string> result_;
+
+  const_span<std::byte>       data_;
+  std::shared_ptr<const void> storage_;
+};
+
+/**
+ * Statistics gathered while generating output for a specific pipeline stage.
+ */
+struct stage_stats {
+  /**
+   * The number of code generation passes SPIRV-Cross made to produce the output. SPIRV-Cross starts
+   * code generation over whenever it discovers that earlier output needs to be changed, so values
+   * above 1 indicate shaders that are more expensive to cross-compile. Always 0 for SPIR-V targets.
+   */
+  uint32_t codegen_passes = 0u;
+
+  /**
+   * The number of bytes of debug instructions removed from SPIR-V output when
+   * \ref instance::options::strip_debug_info is set. Always 0 for other targets.
+   */
+  uint32_t stripped_debug_bytes = 0u;
 };
 
 /**
@@ -103,12 +137,20 @@ struct compiled_stage {
    * It is not set for other types of shaders.
    */
   std::optional<std::array<uint32_t, 3>> threadgroup_size;
+
+  /**
+   * Statistics gathered while generating the output.
+   */
+  stage_stats stats;
 };
 
 /**
  * A container for target-specific output.
  */
 struct targeted_output {
+  targeted_output() = default;
+  explicit targeted_output(std::pmr::memory_resource* resource) : stages {resource} {}
+
   /**
    * The description of the target for which the output was generated.
    */
@@ -118,7 +160,7 @@ struct targeted_output {
    * A vector of generated target-specific shaders. Each element corresponds to a single pipeline
    * stage.
    */
-  std::vector<compiled_stage> stages;
+  arena_vector<compiled_stage> stages;
 };
 
 
@@ -126,6 +168,7 @@ struct targeted_output {
  * Describes a variable used as an input or output for a pipeline stage.
  */
 struct interface_variable {
+  /** Base types. The values match NGF_PLMD_BASE_TYPE_... in metadata-parser.h. */
   enum type {
     Unknown,
     Void,
@@ -146,8 +189,8 @@ struct interface_variable {
     TypeCount
   };
 
-  /** Variable name (as used in SPIR-V). */
-  std::string name;
+  /** Variable name (as used in SPIR-V). Points into \ref compiled_technique::strings. */
+  std::string_view name;
 
   /**
    * Type code.
@@ -169,9 +212,9 @@ struct interface_variable {
  * Descriptions of input and output variables used by a pipeline stage.
  */
 struct interface_variables {
-  pipeline_stage                  stage;
-  std::vector<interface_variable> input_vars;
-  std::vector<interface_variable> output_vars;
+  pipeline_stage                   stage;
+  arena_vector<interface_variable> input_vars;
+  arena_vector<interface_variable> output_vars;
 };
 
 /**
@@ -180,13 +223,17 @@ struct interface_variables {
 struct compiled_technique {
   compiled_technique()                     = default;
   compiled_technique(compiled_technique&&) = default;
+  explicit compiled_technique(std::pmr::memory_resource* resource)
+      : targeted_outputs {resource},
+        per_stage_interface {resource} {
+  }
   compiled_technique& operator=(compiled_technique&&) = default;
 
   /** The name of the technique for which the shaders were generated. */
   std::string name;
 
   /** A vector of per-target output. Each element corresponds to a single target. */
-  std::vector<targeted_output> targeted_outputs;
+  arena_vector<targeted_output> targeted_outputs;
 
   /**
    * The pipeline layout, containing information about all resources used by all pipeline stages.
@@ -215,11 +262,20 @@ struct compiled_technique {
   /**
    * Descriptions of input and output interface variables for each stage of this technique.
    */
-  std::vector<interface_variables> per_stage_interface;
+  arena_vector<interface_variables> per_stage_interface;
+
+  /**
+   * Interned storage for the descriptor, specialization constant and interface variable names
+   * referenced by this technique. The pool is shared by all techniques produced by the same call to
+   * \ref instance::compile, and each distinct name is stored in it once. For techniques loaded by
+   * \ref deserialize_techniques, the names point into the serialized data instead, which the pool
+   * keeps alive. Names obtained from this technique must not outlive it (or a copy of this pointer).
+   */
+  std::shared_ptr<const string_pool> strings;
 };
 
 /** A vector of \ref compiled_technique objects. */
-using compiled_techniques = std::vector<compiled_technique>;
+using compiled_techniques = arena_vector<compiled_technique>;
 
 /**
  * A sequence of \ref technique_desc objects parsed out of inline technique definitions in the
@@ -22,11 +22,14 @@
 
 #pragma once
 
+#include "libniceshade/allocator.h"
+#include "libniceshade/span.h"
+
+#include <algorithm>
+#include <optional>
 #include <stdint.h>
-#include <string>
+#include <string_view>
 #include <vector>
-#include <map>
-#include <optional>
 
 /**
  * @file
@@ -67,7 +70,8 @@ struct descriptor {
   uint32_t        slot;                                   /**< A descriptor's binding within its set.*/
   descriptor_type type       = descriptor_type::INVALID;  /**< Type of resorce accessed. */
   uint32_t        stage_mask = 0u;  /**< A bitmask indicating the pipeline stages that the descriptor is used from. */
-  std::string     name;             /**< The name used to refer to the descriptor in the shader's source code. */
+  std::string_view name;            /**< The name used to refer to the descriptor in the shader's source code. Points into
+                                         \ref compiled_technique::strings. */
   uint32_t        native_binding;   /**< The actual binding used by the target API (if a remapping from descriptor/set model is needed). */
   bool            is_array;         /**< Set to true if the descriptor pertains to an array (e.g. array of textures). */
   uint32_t        array_size;       /**< If the descriptor pertains to an array, this holds the array size. If the array size is not known at
@@ -75,22 +79,156 @@ struct descriptor {
 };
 
 /**
- * Specifies the layout of a descriptor set. The key is the descriptor index, the value is
- * descriptor-related data.
+ * Describes a member of a uniform buffer, storage buffer or push constant block. The members of
+ * nested structures are described as well, after the structure itself, with names like
+ * `outer.inner`. For arrays of structures, the members of the first element are described, with
+ * names like `outer[0].inner`.
  */
-using descriptor_set_layout = std::map<uint32_t, descriptor>;
+struct block_member {
+  std::string_view name;          /**< Name of the member. Points into \ref compiled_technique::strings. */
+  uint32_t         offset;        /**< Offset of the member from the start of the block, in bytes. */
+  uint32_t         size;          /**< Size of the member in bytes, including all array elements. Zero for arrays whose size is not known at compile time. */
+  uint32_t         vecsize;       /**< Number of vector components (rows, for matrices). */
+  uint32_t         columns;       /**< Number of matrix columns, 1 for vectors and scalars. */
+  bool             is_array;      /**< Set to true if the member is an array. */
+  uint32_t         array_size;    /**< If the member is an array, this holds the array size. If the array size is not known at
+                                       compile time (e.g. a runtime-sized array), this will be set to 0xffffffff. */
+  uint32_t         array_stride;  /**< Distance between array elements in bytes, or 0 if the member is not an array. */
+  uint32_t         matrix_stride; /**< Distance between matrix columns (or rows, if \ref row_major), or 0 if the member is not a matrix. */
+  bool             row_major;     /**< Set to true if the member is a matrix stored in row-major order. */
+};
+
+/**
+ * Specifies the memory layout of a uniform buffer, storage buffer or push constant block. This is a
+ * lightweight view into the storage of the \ref pipeline_layout that it was obtained from, and
+ * remains valid for as long as that pipeline layout is alive.
+ */
+struct block_layout {
+  /**
+   * Size of the block in bytes. For blocks that end with an array whose size is not known at
+   * compile time, this excludes the array.
+   */
+  uint32_t size = 0u;
+
+  /** The members of the block, in order of their offsets. */
+  const_span<block_member> members;
+};
+
+/**
+ * The largest descriptor set index that a shader may use. Sets are looked up by index, and every
+ * set up to the largest one used is part of a \ref pipeline_layout, so larger indices are rejected
+ * rather than allocating storage for them.
+ */
+constexpr uint32_t max_descriptor_set_index = 255u;
+
+/**
+ * Specifies the layout of a descriptor set. This is a lightweight view into the storage of the
+ * \ref pipeline_layout that it was obtained from, and remains valid for as long as that pipeline
+ * layout is alive. Iterating over it yields descriptors in ascending order of their binding index
+ * (\ref descriptor::slot).
+ */
+class descriptor_set_layout {
+  friend class pipeline_layout;
+
+public:
+  /** Iterator for the contents of the descriptor set layout. Points to a \ref descriptor. */
+  using iterator = const descriptor*;
+
+  descriptor_set_layout() = default;
+
+  /** @return The index of the descriptor set. */
+  uint32_t set_id() const noexcept { return set_id_; }
+
+  /** @return The number of descriptors in the set. */
+  size_t size() const noexcept { return (size_t)(end_ - begin_); }
+
+  /** @return true if the set has no descriptors. */
+  bool empty() const noexcept { return begin_ == end_; }
+
+  /** @return an iterator pointing to the first descriptor in the set. */
+  iterator begin() const noexcept { return begin_; }
+
+  /** @return end iterator of the descriptor set layout. */
+  iterator end() const noexcept { return end_; }
+
+  /**
+   * @param binding The binding index of the descriptor to look up.
+   * @return A pointer to the descriptor at the specified binding, or nullptr if there is none. The
+   *         lookup takes constant time, unless the binding indices used by the set are very sparse,
+   *         in which case it falls back to a binary search.
+   */
+  const descriptor* find(uint32_t binding) const noexcept {
+    if (binding_lut_ != nullptr) {
+      if (binding >= binding_lut_size_ || binding_lut_[binding] == ~0u) { return nullptr; }
+      return begin_ + binding_lut_[binding];
+    }
+    const descriptor* it = std::lower_bound(
+        begin_,
+        end_,
+        binding,
+        [](const descriptor& d, uint32_t b) { return d.slot < b; });
+    return (it != end_ && it->slot == binding) ? it : nullptr;
+  }
+
+private:
+  uint32_t          set_id_           = 0u;
+  const descriptor* begin_            = nullptr;
+  const descriptor* end_              = nullptr;
+  const uint32_t*   binding_lut_      = nullptr;  // Binding index -> offset from begin_, or ~0u.
+  uint32_t          binding_lut_size_ = 0u;
+};
 
 /**
  * Stores information about all shader resources accessed by a technique.
+ *
+ * All descriptors are kept in a single contiguous array, sorted by descriptor set index and then
+ * by binding index. Each non-empty descriptor set occupies a contiguous range of that array.
  */
 class pipeline_layout {
   friend class pipeline_layout_builder;
+  friend class technique_serializer;
+
+  // Describes the range of the descriptor array occupied by a single descriptor set.
+  struct set_range {
+    uint32_t set_id;
+    uint32_t first_descriptor;
+    uint32_t descriptor_count;
+    uint32_t first_lut_entry;  // Offset of the set's binding lookup table in binding_lut_.
+    uint32_t lut_size;         // Zero if the set has no binding lookup table.
+  };
+
+  // Describes the range of the block member array occupied by a single block.
+  struct block_range {
+    uint32_t size;
+    uint32_t first_member;
+    uint32_t member_count;
+  };
+
 public:
   /**
-   * Iterator for the contents for the pipeline layout. Points to a pair of descriptor set index
-   * and descriptor set layout.
+   * Iterator for the contents for the pipeline layout. Visits non-empty descriptor sets in
+   * ascending order of their index, and points to a \ref descriptor_set_layout.
    */
-  using iterator = std::map<uint32_t, descriptor_set_layout>::const_iterator;
+  class iterator {
+  public:
+    iterator(const pipeline_layout* layout, const set_range* range) noexcept
+        : layout_ {layout},
+          range_ {range} {
+    }
+    descriptor_set_layout operator*() const noexcept { return layout_->make_set_layout(*range_); }
+    iterator&             operator++() noexcept {
+      ++range_;
+      return *this;
+    }
+    bool operator==(const iterator& other) const noexcept { return range_ == other.range_; }
+    bool operator!=(const iterator& other) const noexcept { return range_ != other.range_; }
+
+  private:
+    const pipeline_layout* layout_;
+    const set_range*       range_;
+  };
+
+  pipeline_layout() = default;
 
   /** @return The total number of descriptor sets in the layout. */
   uint32_t set_count() const noexcept { return max_set_ + 1; }
@@ -102,26 +240,106 @@ public:
    * @param set_id The id of the descriptor set to retrieve the layour for.
    * @return The layout of the specified descriptor set.
    */
-  const descriptor_set_layout& set(uint32_t set_id) const noexcept {
-    static const descriptor_set_layout empty_layout {};
-    auto it = sets_.find(set_id);
-    return (it != sets_.cend()) ? it->second : empty_layout;
+  descriptor_set_layout set(uint32_t set_id) const noexcept {
+    if (set_id >= set_lut_.size() || set_lut_[set_id] == ~0u) {
+      descriptor_set_layout empty_layout;
+      empty_layout.set_id_ = set_id;
+      return empty_layout;
+    }
+    return make_set_layout(set_ranges_[set_lut_[set_id]]);
+  }
+
+  /**
+   * @param set_id The descriptor set index.
+   * @param binding The binding index within the descriptor set.
+   * @return A pointer to the descriptor at the given set and binding, or nullptr if there is none.
+   *         See \ref descriptor_set_layout::find for complexity.
+   */
+  const descriptor* find(uint32_t set_id, uint32_t binding) const noexcept {
+    return set(set_id).find(binding);
+  }
+
+  /**
+   * @return All descriptors in the layout, sorted by descriptor set index and then by binding
+   *         index.
+   */
+  const_span<descriptor> descriptors() const noexcept {
+    return const_span<descriptor> {descriptors_.data(), descriptors_.size()};
   }
 
   /** @return an interator pointing to the beginning of the pipeline layout. */
-  iterator begin() const noexcept { return sets_.begin(); }
+  iterator begin() const noexcept { return iterator {this, set_ranges_.data()}; }
 
   /** @return end iterator of the pipeline layout. */
-  iterator end() const noexcept { return sets_.end(); }
+  iterator end() const noexcept {
+    return iterator {this, set_ranges_.data() + set_ranges_.size()};
+  }
 
   /** @return native binding id associated with the push const buffer. */
   const std::optional<uint32_t>& push_consts_native_binding() const noexcept { return push_consts_native_binding_; }
 
+  /**
+   * @param desc A descriptor obtained from this pipeline layout.
+   * @return The memory layout of the uniform or storage buffer accessed through the descriptor, or
+   *         std::nullopt if the descriptor does not refer to a buffer.
+   */
+  std::optional<block_layout> buffer_block(const descriptor& desc) const noexcept {
+    const size_t desc_idx = (size_t)(&desc - descriptors_.data());
+    if (desc_idx >= descriptor_blocks_.size() || descriptor_blocks_[desc_idx] == ~0u) {
+      return std::nullopt;
+    }
+    return make_block_layout(blocks_[descriptor_blocks_[desc_idx]]);
+  }
+
+  /** @return The memory layout of the push constant block, or std::nullopt if there is none. */
+  std::optional<block_layout> push_consts_block() const noexcept {
+    if (push_consts_block_ == ~0u) { return std::nullopt; }
+    return make_block_layout(blocks_[push_consts_block_]);
+  }
+
 private:
-  std::map<uint32_t, descriptor_set_layout> sets_;   // shouldn't be unordered_map to guarantee consistent order.
-  uint32_t                           max_set_ = 0u;  // Max set number encountered.
-  uint32_t                           nres_    = 0u;  // Total number of resources.
-  std::optional<uint32_t>            push_consts_native_binding_;
+  explicit pipeline_layout(std::pmr::memory_resource* resource) noexcept
+      : descriptors_ {resource},
+        set_ranges_ {resource},
+        set_lut_ {resource},
+        binding_lut_ {resource},
+        blocks_ {resource},
+        block_members_ {resource},
+        descriptor_blocks_ {resource} {
+  }
+
+  block_layout make_block_layout(const block_range& range) const noexcept {
+    block_layout result;
+    result.size    = range.size;
+    result.members = const_span<block_member> {
+        block_members_.data() + range.first_member,
+        range.member_count};
+    return result;
+  }
+
+  descriptor_set_layout make_set_layout(const set_range& range) const noexcept {
+    descriptor_set_layout result;
+    result.set_id_ = range.set_id;
+    result.begin_  = descriptors_.data() + range.first_descriptor;
+    result.end_    = result.begin_ + range.descriptor_count;
+    if (range.lut_size > 0u) {
+      result.binding_lut_      = binding_lut_.data() + range.first_lut_entry;
+      result.binding_lut_size_ = range.lut_size;
+    }
+    return result;
+  }
+
+  arena_vector<descriptor> descriptors_;  // Sorted by set, then binding, to guarantee consistent order.
+  arena_vector<set_range>  set_ranges_;   // Non-empty sets, sorted by set index.
+  arena_vector<uint32_t>   set_lut_;      // Set index -> index into set_ranges_, or ~0u.
+  arena_vector<uint32_t>   binding_lut_;  // Concatenated per-set binding lookup tables.
+  uint32_t                 max_set_ = 0u; // Max set number encountered.
+  uint32_t                 nres_    = 0u; // Total number of resources.
+  std::optional<uint32_t>  push_consts_native_binding_;
+  arena_vector<block_range>  blocks_;             // Uniform, storage and push constant blocks.
+  arena_vector<block_member> block_members_;      // Concatenated members of all blocks.
+  arena_vector<uint32_t>     descriptor_blocks_;  // Descriptor index -> index into blocks_, or ~0u.
+  uint32_t                   push_consts_block_ = ~0u;  // Index into blocks_, or ~0u.
 };
 
 }  // namespace niceshade
@@ -22,11 +22,12 @@
 
 #pragma once
 
-#include "spirv_reflect.hpp"
+#include "libniceshade/allocator.h"
+#include "libniceshade/span.h"
 
-#include <map>
-#include <set>
+#include <algorithm>
 #include <stdint.h>
+#include <vector>
 
 namespace niceshade {
 
@@ -34,10 +35,105 @@ struct set_and_binding {
   uint32_t set;
   uint32_t binding;
   bool     operator<(const set_and_binding& rhs) const {
-    return set < rhs.set ? true : binding < rhs.binding;
+    return set < rhs.set || (set == rhs.set && binding < rhs.binding);
+  }
+  bool operator==(const set_and_binding& rhs) const {
+    return set == rhs.set && binding == rhs.binding;
   }
 };
 
-using separate_to_combined_map =  std::map<set_and_binding, std::set<uint32_t>>;
+/**
+ * Maps separate image or sampler bindings to the bindings of auto-generated combined
+ * image/samplers that use them.
+ *
+ * Entries are stored in a flat array sorted by descriptor set and binding, and the combined
+ * binding IDs of all entries share a single contiguous array.
+ */
+class separate_to_combined_map {
+  friend class separate_to_combined_builder;
+  friend class technique_serializer;
+
+  struct record {
+    set_and_binding resource;
+    uint32_t        first_combined_id;
+    uint32_t        combined_id_count;
+  };
+
+public:
+  /**
+   * A single entry of the map.
+   */
+  struct value_type {
+    set_and_binding      resource;     /**< Set and binding of the separate image or sampler. */
+    const_span<uint32_t> combined_ids; /**< Bindings of the combined image/samplers, sorted. */
+  };
+
+  /**
+   * Iterator for the contents of the map. Visits entries in ascending order of set and binding,
+   * and points to a \ref value_type.
+   */
+  class iterator {
+  public:
+    iterator(const separate_to_combined_map* map, const record* rec) noexcept
+        : map_ {map},
+          rec_ {rec} {
+    }
+    value_type operator*() const noexcept { return map_->make_value(*rec_); }
+    iterator&  operator++() noexcept {
+      ++rec_;
+      return *this;
+    }
+    bool operator==(const iterator& other) const noexcept { return rec_ == other.rec_; }
+    bool operator!=(const iterator& other) const noexcept { return rec_ != other.rec_; }
+
+  private:
+    const separate_to_combined_map* map_;
+    const record*                   rec_;
+  };
+
+  separate_to_combined_map() = default;
+
+  /** @return The number of entries in the map. */
+  size_t size() const noexcept { return records_.size(); }
+
+  /** @return true if the map has no entries. */
+  bool empty() const noexcept { return records_.empty(); }
+
+  /** @return an iterator pointing to the first entry of the map. */
+  iterator begin() const noexcept { return iterator {this, records_.data()}; }
+
+  /** @return end iterator of the map. */
+  iterator end() const noexcept { return iterator {this, records_.data() + records_.size()}; }
+
+  /**
+   * @param resource Set and binding of a separate image or sampler.
+   * @return Bindings of the combined image/samplers that use the given resource. Empty if there are
+   *         none.
+   */
+  const_span<uint32_t> find(const set_and_binding& resource) const noexcept {
+    auto it = std::lower_bound(
+        records_.begin(),
+        records_.end(),
+        resource,
+        [](const record& r, const set_and_binding& sb) { return r.resource < sb; });
+    return (it != records_.end() && it->resource == resource) ? make_value(*it).combined_ids
+                                                              : const_span<uint32_t> {};
+  }
+
+private:
+  explicit separate_to_combined_map(std::pmr::memory_resource* resource) noexcept
+      : records_ {resource},
+        combined_ids_ {resource} {
+  }
+
+  value_type make_value(const record& r) const noexcept {
+    return value_type {
+        r.resource,
+        const_span<uint32_t> {combined_ids_.data() + r.first_combined_id, r.combined_id_count}};
+  }
+
+  arena_vector<record>   records_;       // Sorted by set and binding.
+  arena_vector<uint32_t> combined_ids_;  // Combined binding IDs of all records.
+};
 
-}  // namespace niceshade
\ No newline at end of file
+}  // namespace niceshade
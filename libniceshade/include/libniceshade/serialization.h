@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "libniceshade/common-types.h"
+#include "libniceshade/error.h"
+#include "libniceshade/output.h"
+#include "libniceshade/span.h"
+
+#include <memory>
+#include <memory_resource>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @file
+ * @brief
+ */
+
+namespace niceshade {
+
+/**
+ * Version of the binary format written by \ref serialize_techniques. Data written with a different
+ * version is rejected by \ref deserialize_techniques.
+ */
+constexpr uint32_t serialized_techniques_version = 4u;
+
+/**
+ * Writes compiled techniques into a compact binary blob that can be loaded back with
+ * \ref deserialize_techniques without recompiling or re-reflecting anything. The blob contains the
+ * pipeline layouts, specialization constants, separate-to-combined maps, interface variables and
+ * the output for every target and stage.
+ *
+ * The blob uses the byte order of the machine that wrote it, and all of its sections are 8-byte
+ * aligned, so that it can be loaded mostly with bulk copies. Loading it on a machine with a
+ * different byte order fails.
+ *
+ * @param techniques The techniques to serialize.
+ * @return The serialized data.
+ * @throws std::bad_alloc if there isn't enough memory for the serialized data.
+ */
+std::vector<std::byte> serialize_techniques(const compiled_techniques& techniques);
+
+/**
+ * Loads techniques from data written by \ref serialize_techniques.
+ *
+ * @param data The serialized data.
+ * @param owner Optional owner of the memory that `data` points into. If it is set and `data` is
+ * 8-byte aligned, the shader code and the names of the loaded techniques refer to `data` directly,
+ * and the techniques keep a reference to `owner`. Otherwise, the data is copied once, into a
+ * buffer that the loaded techniques share.
+ * @param resource The memory resource to allocate the loaded techniques from, see
+ * \ref instance::compile.
+ * @return The loaded techniques, or an error if the data is malformed or was written with a
+ * different format version or byte order.
+ */
+value_or_error<compiled_techniques> deserialize_techniques(
+    const_span<std::byte>       data,
+    std::shared_ptr<const void> owner    = nullptr,
+    std::pmr::memory_resource*  resource = std::pmr::get_default_resource()) noexcept;
+
+}  // namespace niceshade
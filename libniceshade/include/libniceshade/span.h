@@ -35,6 +35,8 @@ public:
   span(T* ptr, size_t size) : ptr_(ptr), size_(size) {}
 
   size_t         size() const { return size_; }
+  T*             data() { return ptr_; }
+  const T*       data() const { return ptr_; }
   iterator       begin() { return ptr_; }
   const_iterator begin() const { return ptr_; }
   const_iterator cbegin() const { return ptr_; }
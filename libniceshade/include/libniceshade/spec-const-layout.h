@@ -1,10 +1,12 @@
 #pragma once
 
+#include "allocator.h"
 #include "error.h"
+#include "string-pool.h"
 
 #include <stdint.h>
 #include <map>
-#include <string>
+#include <string_view>
 
 namespace niceshade {
 
@@ -13,15 +15,26 @@ struct spec_const {
   uint32_t type_id;  // TODO: use enum
 };
 
-using spec_const_layout = std::map<std::string, spec_const>;
+// Keys point into the string pool of the technique that the layout belongs to.
+using spec_const_layout = std::map<
+    std::string_view,
+    spec_const,
+    std::less<std::string_view>,
+    arena_allocator<std::pair<const std::string_view, spec_const>>>;
 
 class spec_const_layout_builder {
 private:
-  std::map<std::string, spec_const> layout_;
+  string_pool*      strings_;
+  spec_const_layout layout_;
 
 public:
+  spec_const_layout_builder(string_pool& strings, std::pmr::memory_resource* resource)
+      : strings_ {&strings},
+        layout_ {resource} {
+  }
+
   error add_spec_const(const std::string_view name, spec_const constant) {
-    auto insert_result = layout_.insert(std::make_pair(name, constant));
+    auto insert_result = layout_.insert(std::make_pair(strings_->intern(name), constant));
     return (!insert_result.second && (insert_result.first->second.id != constant.id ||
                                       insert_result.first->second.type_id != constant.type_id))
                ? error {"Spec constant redefinition: ", name}
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @file
+ * @brief
+ */
+
+namespace niceshade {
+
+/**
+ * A string interning table. Each distinct string is stored only once, and all views returned for
+ * it by \ref intern refer to the same memory. Views stay valid for as long as the pool is alive.
+ */
+class string_pool {
+public:
+  /**
+   * @param resource The memory resource to allocate pooled strings from.
+   */
+  explicit string_pool(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : storage_ {resource},
+        index_ {resource},
+        retained_ {resource} {
+  }
+  string_pool(const string_pool&) = delete;
+  string_pool& operator=(const string_pool&) = delete;
+
+  /**
+   * @param str The string to intern.
+   * @return A view of the pooled copy of the given string.
+   */
+  std::string_view intern(std::string_view str) {
+    auto it = index_.find(str);
+    if (it != index_.end()) { return *it; }
+    const std::pmr::string& stored = storage_.emplace_back(str);
+    return *index_.emplace(stored).first;
+  }
+
+  /**
+   * Keeps the given storage alive for as long as the pool is. This lets views of strings that live
+   * in that storage be handed out alongside pooled ones, without copying them into the pool.
+   * @param storage The owner of the memory the views point into.
+   */
+  void retain(std::shared_ptr<const void> storage) { retained_.push_back(std::move(storage)); }
+
+  /** @return The number of distinct strings in the pool. */
+  size_t size() const noexcept { return storage_.size(); }
+
+private:
+  std::pmr::deque<std::pmr::string>             storage_;  // Elements never move once inserted.
+  std::pmr::unordered_set<std::string_view>     index_;
+  std::pmr::vector<std::shared_ptr<const void>> retained_;
+};
+
+}  // namespace niceshade
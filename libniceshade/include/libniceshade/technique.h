@@ -38,7 +38,33 @@ struct technique_desc {
 
   std::string      name;    /**< The name of the technique.*/
   define_container defines; /**< Additional definitions to be added to the preprocessor while
-                                 compiling this technique. */
+                                 compiling this technique. For parsed techniques, this only holds
+                                 the technique's own `define` tags, see \ref shared_defines. */
+
+  /**
+   * Definitions shared between many techniques. These are added to the preprocessor before
+   * \ref defines. May be null.
+   *
+   * For techniques parsed by \ref instance::parse_techniques_and_compile, this holds the global
+   * definitions passed to it, and all techniques from the same input point to the same container.
+   * Use \ref all_defines to get the complete list of definitions for the technique.
+   */
+  std::shared_ptr<const define_container> shared_defines;
+
+  /**
+   * @return A copy of \ref shared_defines followed by \ref defines, in the order in which they are
+   * passed to the preprocessor.
+   */
+  define_container all_defines() const {
+    define_container result;
+    result.reserve(defines.size() + (shared_defines ? shared_defines->size() : 0u));
+    if (shared_defines) {
+      result.insert(result.end(), shared_defines->begin(), shared_defines->end());
+    }
+    result.insert(result.end(), defines.begin(), defines.end());
+    return result;
+  }
+
   std::vector<entry_point> entry_points; /**< Entry point specifications for the technique. */
 
   /**
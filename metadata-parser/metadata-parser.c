@@ -23,14 +23,9 @@
 #include "metadata-parser.h"
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
-#if defined(_WIN32) || defined(_WIN64)
-  #pragma comment(lib, "ws2_32.lib")
-  #include <winsock2.h>
-#else
-  #include <arpa/inet.h>
-#endif
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -47,193 +42,986 @@ static const ngf_plmd_alloc_callbacks stdlib_alloc = {
 #pragma warning( pop )
 #endif
 
+static const uint32_t START_OF_RAW_BYTE_BLOCK = 0xffffffff;
+static const uint32_t MAGIC_NUMBER = 0xdeadbeef;
+
+// Descriptor index of a native file, which is used in place.
+typedef struct _plmd_descriptor_index {
+  const ngf_plmd_native_descriptor_name *names;
+  const uint32_t *displacements;
+  const uint32_t *slots;
+  const uint32_t *table_offsets;
+  const uint8_t *section_data;
+  const char *strings;
+  uint32_t nbuckets;
+  uint32_t nslots;
+  uint32_t ntables;
+} _plmd_descriptor_index;
+
 struct ngf_plmd {
-  uint8_t *raw_data;
+  const uint8_t *raw_data;
   const ngf_plmd_header *header;
+  const ngf_plmd_native_header *native_header;
   ngf_plmd_entrypoints entrypoints;
   ngf_plmd_layout layout;
   ngf_plmd_cis_map images_to_cis_map;
   ngf_plmd_cis_map samplers_to_cis_map;
   ngf_plmd_user user;
   const ngf_plmd_threadgroup_size *threadgroup_size;
+  ngf_plmd_native_binding_map native_binding_map;
+  bool has_native_binding_map;
+  ngf_plmd_descriptor_pool_sizes descriptor_pool_sizes;
+  ngf_plmd_interface_vars interface_vars;
+  bool has_interface_vars;
+  ngf_plmd_block_layouts block_layouts;
+  bool has_block_layouts;
+  _plmd_descriptor_index descriptor_index;
+  bool has_descriptor_index;
+  // Native files have no legacy header, so one is synthesized from their
+  // section table.
+  ngf_plmd_header header_storage;
 };
 
-static ngf_plmd_error _create_cis_map(uint8_t *ptr,
-                                  const ngf_plmd_alloc_callbacks *cb,
-                                  ngf_plmd_cis_map *map) {
-  assert(ptr);
-  map->nentries = *(uint32_t*)ptr;
-  map->entries = cb->alloc(map->nentries * sizeof(ngf_plmd_cis_map_entry*));
-  if (map->entries == NULL) {
-    return NGF_PLMD_ERROR_OUTOFMEM;
+// Sizes of the index arrays that need to be allocated for a metadata buffer.
+// All of them are stored up front (in the first field of the corresponding
+// record for legacy files, and in the section table for native files), so they
+// can be obtained without walking the whole buffer.
+typedef struct _plmd_index_counts {
+  uint32_t nsets;
+  uint32_t nimage_cis_entries;
+  uint32_t nsampler_cis_entries;
+  uint32_t nuser_entries;
+  uint32_t nnative_binding_sets;
+  uint32_t ninterface_vars;
+  uint32_t nblocks;
+  uint32_t nblock_members;
+} _plmd_index_counts;
+
+// Bounds-checked cursor over a record.
+typedef struct _plmd_reader {
+  const uint8_t *ptr;
+  const uint8_t *end;
+} _plmd_reader;
+
+static uint32_t _bswap32(uint32_t v) {
+  return (v >> 24u) | ((v >> 8u) & 0xff00u) | ((v << 8u) & 0xff0000u) | (v << 24u);
+}
+
+static uint32_t _load_field(const uint8_t *ptr, bool swap) {
+  uint32_t v;
+  memcpy(&v, ptr, sizeof(v));
+  return swap ? _bswap32(v) : v;
+}
+
+static void _swap_fields(uint8_t *ptr, size_t nfields) {
+  uint32_t *fields = (uint32_t*)ptr;
+  for (size_t field_idx = 0u; field_idx < nfields; ++field_idx) {
+    fields[field_idx] = _bswap32(fields[field_idx]);
   }
+}
 
-  size_t offset = 4u;
-  for (uint32_t e = 0u; e < map->nentries; ++e) {
-    map->entries[e] = (ngf_plmd_cis_map_entry*)(ptr + offset);
-    offset += 3 * 4u + map->entries[e]->ncombined_ids * sizeof(uint32_t);
+// Reads the first field of the record whose offset is stored in the given
+// header field.
+static uint32_t _load_record_count(const uint8_t *buf, size_t offset_field,
+                                   bool swap) {
+  return _load_field(buf + _load_field(buf + offset_field, swap), swap);
+}
+
+static const uint32_t* _read_fields(_plmd_reader *r, uint32_t nfields) {
+  if (nfields > (size_t)(r->end - r->ptr) / sizeof(uint32_t)) {
+    return NULL;
   }
+  const uint32_t *fields = (const uint32_t*)r->ptr;
+  r->ptr += nfields * sizeof(uint32_t);
+  return fields;
+}
 
+static ngf_plmd_error _read_string(_plmd_reader *r, const char **str) {
+  const uint32_t *blk_header = _read_fields(r, 2u);
+  if (blk_header == NULL) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+  }
+  if (blk_header[0] != START_OF_RAW_BYTE_BLOCK || blk_header[1] == 0u) {
+    return NGF_PLMD_ERROR_MALFORMED_RECORD;
+  }
+  const char *blk = (const char*)_read_fields(r, blk_header[1]);
+  if (blk == NULL) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+  }
+  // Strings are null-terminated and zero-padded to a multiple of 4 bytes, so
+  // the last byte of the block must always be zero.
+  if (blk[blk_header[1] * sizeof(uint32_t) - 1u] != '\0') {
+    return NGF_PLMD_ERROR_MALFORMED_RECORD;
+  }
+  *str = blk;
   return NGF_PLMD_ERROR_OK;
 }
 
-ngf_plmd_error ngf_plmd_load(const void *buf, size_t buf_size,
-                     const ngf_plmd_alloc_callbacks *alloc_cb,
-                     ngf_plmd **result) {
-  static const uint32_t START_OF_RAW_BYTE_BLOCK = 0xffffffff;
-  static const uint32_t MAGIC_NUMBER = 0xdeadbeef;
-  ngf_plmd_error err = NGF_PLMD_ERROR_OK;
-  ngf_plmd *meta = NULL;
-  assert(buf);
-  assert(result);
+static ngf_plmd_error _set_entrypoint(ngf_plmd *meta, uint32_t stage,
+                                      const char *name) {
+  if (stage == 0) meta->entrypoints.vert_shader_entrypoint = name;
+  else if (stage == 1) meta->entrypoints.frag_shader_entrypoint = name;
+  else if (stage == 2) meta->entrypoints.compute_shader_entrypoint = name;
+  else {
+    return NGF_PLMD_ERROR_INVALID_SHADER_STAGE;
+  }
+  return NGF_PLMD_ERROR_OK;
+}
 
-  // Use stdlib malloc/free by default.
-  if (alloc_cb == NULL) {
-    alloc_cb = &stdlib_alloc;
+static ngf_plmd_error _read_legacy_header(const uint8_t *buf, size_t buf_size,
+                                          bool swap,
+                                          _plmd_index_counts *counts) {
+  if (buf_size < sizeof(ngf_plmd_header)) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
   }
 
+  // Sanity-check offsets in the header.
+  const size_t first_offset_field =
+      offsetof(ngf_plmd_header, entrypoints_offset) / sizeof(uint32_t);
+  const size_t noffset_fields =
+      sizeof(ngf_plmd_header) / sizeof(uint32_t) - first_offset_field;
+  for (size_t o = 0u; o < noffset_fields; ++o) {
+    const uint32_t offset =
+        _load_field(buf + (first_offset_field + o) * sizeof(uint32_t), swap);
+    if (offset > buf_size - sizeof(uint32_t) || (offset & 0b11) != 0) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+  }
+
+  // Read the counts stored at the beginning of records that need an index.
+  // Each indexed item takes up at least one field, which bounds the counts.
+  const uint32_t max_count = (uint32_t)(buf_size / sizeof(uint32_t));
+  counts->nsets = _load_record_count(
+      buf, offsetof(ngf_plmd_header, pipeline_layout_offset), swap);
+  counts->nimage_cis_entries = _load_record_count(
+      buf, offsetof(ngf_plmd_header, image_to_cis_map_offset), swap);
+  counts->nsampler_cis_entries = _load_record_count(
+      buf, offsetof(ngf_plmd_header, sampler_to_cis_map_offset), swap);
+  counts->nuser_entries = _load_record_count(
+      buf, offsetof(ngf_plmd_header, user_metadata_offset), swap);
+  if (counts->nsets > max_count || counts->nimage_cis_entries > max_count ||
+      counts->nsampler_cis_entries > max_count || counts->nuser_entries > max_count) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+  }
+  counts->nnative_binding_sets = 0u;
+  counts->ninterface_vars = 0u;
+  counts->nblocks = 0u;
+  counts->nblock_members = 0u;
+
+  return NGF_PLMD_ERROR_OK;
+}
+
+static ngf_plmd_section _load_section(const uint8_t *buf, uint32_t section_id,
+                                      bool swap) {
+  const uint8_t *ptr = buf + sizeof(ngf_plmd_native_header) +
+                       section_id * sizeof(ngf_plmd_section);
+  ngf_plmd_section section;
+  section.offset = _load_field(ptr + offsetof(ngf_plmd_section, offset), swap);
+  section.size = _load_field(ptr + offsetof(ngf_plmd_section, size), swap);
+  section.count = _load_field(ptr + offsetof(ngf_plmd_section, count), swap);
+  section.reserved = 0u;
+  return section;
+}
+
+static ngf_plmd_error _read_native_header(const uint8_t *buf, size_t buf_size,
+                                          bool swap,
+                                          _plmd_index_counts *counts) {
+  if (buf_size < sizeof(ngf_plmd_native_header)) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+  }
+
+  // Sanity-check the section table. Sections added by later minor versions
+  // are allowed to be present, but all of the ones defined by version 1.0 are
+  // required.
+  const uint32_t header_size =
+      _load_field(buf + offsetof(ngf_plmd_native_header, header_size), swap);
+  const uint32_t nsections =
+      _load_field(buf + offsetof(ngf_plmd_native_header, nsections), swap);
+  if (nsections < NGF_PLMD_REQUIRED_SECTION_COUNT) {
+    return NGF_PLMD_ERROR_MALFORMED_RECORD;
+  }
+  if (nsections > (buf_size - sizeof(ngf_plmd_native_header)) / sizeof(ngf_plmd_section) ||
+      header_size < sizeof(ngf_plmd_native_header) + nsections * sizeof(ngf_plmd_section) ||
+      header_size > buf_size) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+  }
+  // Sections may not overlap the header, so that converting them to host byte
+  // order never modifies the section table.
+  for (uint32_t s = 0u; s < nsections; ++s) {
+    const ngf_plmd_section section = _load_section(buf, s, swap);
+    if ((section.offset & 0b111) != 0 || section.offset < header_size ||
+        (s != NGF_PLMD_SECTION_STRING_TABLE && (section.size & 0b11) != 0)) {
+      return NGF_PLMD_ERROR_MALFORMED_RECORD;
+    }
+    if (section.size > buf_size || section.offset > buf_size - section.size) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+  }
+  // Sections may not overlap each other either, so that each field is
+  // converted to host byte order exactly once, and the counts read here stay
+  // valid after conversion.
+  for (uint32_t s = 0u; s < nsections; ++s) {
+    const ngf_plmd_section a = _load_section(buf, s, swap);
+    for (uint32_t t = s + 1u; t < nsections; ++t) {
+      const ngf_plmd_section b = _load_section(buf, t, swap);
+      if (a.size > 0u && b.size > 0u && a.offset < b.offset + b.size &&
+          b.offset < a.offset + a.size) {
+        return NGF_PLMD_ERROR_MALFORMED_RECORD;
+      }
+    }
+  }
+
+  // Read the counts of items that need an index. Each of them takes up at
+  // least one field in the corresponding section, which bounds the counts.
+  const ngf_plmd_section layout =
+      _load_section(buf, NGF_PLMD_SECTION_PIPELINE_LAYOUT, swap);
+  const ngf_plmd_section image_to_cis_map =
+      _load_section(buf, NGF_PLMD_SECTION_IMAGE_TO_CIS_MAP, swap);
+  const ngf_plmd_section sampler_to_cis_map =
+      _load_section(buf, NGF_PLMD_SECTION_SAMPLER_TO_CIS_MAP, swap);
+  const ngf_plmd_section user_metadata =
+      _load_section(buf, NGF_PLMD_SECTION_USER_METADATA, swap);
+  counts->nsets = layout.count;
+  counts->nimage_cis_entries = image_to_cis_map.count;
+  counts->nsampler_cis_entries = sampler_to_cis_map.count;
+  counts->nuser_entries = user_metadata.count;
+  if (counts->nsets > layout.size / sizeof(uint32_t) ||
+      counts->nimage_cis_entries > image_to_cis_map.size / sizeof(uint32_t) ||
+      counts->nsampler_cis_entries > sampler_to_cis_map.size / sizeof(uint32_t) ||
+      counts->nuser_entries > user_metadata.size / sizeof(ngf_plmd_native_user_entry)) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+  }
+  counts->nnative_binding_sets = 0u;
+  if (nsections > NGF_PLMD_SECTION_NATIVE_BINDING_MAP) {
+    const ngf_plmd_section native_binding_map =
+        _load_section(buf, NGF_PLMD_SECTION_NATIVE_BINDING_MAP, swap);
+    counts->nnative_binding_sets = native_binding_map.count;
+    if (counts->nnative_binding_sets > native_binding_map.size / sizeof(uint32_t)) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+  }
+  counts->ninterface_vars = 0u;
+  if (nsections > NGF_PLMD_SECTION_INTERFACE_VARS) {
+    const ngf_plmd_section interface_vars =
+        _load_section(buf, NGF_PLMD_SECTION_INTERFACE_VARS, swap);
+    counts->ninterface_vars = interface_vars.count;
+    if (counts->ninterface_vars >
+        interface_vars.size / sizeof(ngf_plmd_native_interface_var)) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+  }
+  // The first field of the block layouts section holds the total number of
+  // block members.
+  counts->nblocks = 0u;
+  counts->nblock_members = 0u;
+  if (nsections > NGF_PLMD_SECTION_BLOCK_LAYOUTS) {
+    const ngf_plmd_section block_layouts =
+        _load_section(buf, NGF_PLMD_SECTION_BLOCK_LAYOUTS, swap);
+    if (block_layouts.size < sizeof(uint32_t)) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    counts->nblocks = block_layouts.count;
+    counts->nblock_members = _load_field(buf + block_layouts.offset, swap);
+    if (counts->nblocks > block_layouts.size / sizeof(uint32_t) ||
+        counts->nblock_members >
+            block_layouts.size / sizeof(ngf_plmd_native_block_member)) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+  }
+
+  return NGF_PLMD_ERROR_OK;
+}
+
+// Validates the header of a metadata buffer, determines whether its fields
+// need to be byte-swapped and reads the sizes of the index arrays.
+static ngf_plmd_error _read_header(const uint8_t *buf, size_t buf_size,
+                                   bool *swap, uint32_t *version_maj,
+                                   _plmd_index_counts *counts) {
   // Any well-formed pipeline metadata file must contain a multiple of 4 bytes.
   if ((buf_size & 0b11) != 0) {
-    err = NGF_PLMD_ERROR_WEIRD_BUFFER_SIZE;
-    goto ngf_plmd_load_cleanup;
+    return NGF_PLMD_ERROR_WEIRD_BUFFER_SIZE;
+  }
+  // The magic number and version fields are at the same place in all formats.
+  if (buf_size < 4u * sizeof(uint32_t)) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
   }
-  const uint32_t nfields = ((uint32_t)buf_size) >> 2u; // number of 4 byte
-                                                       // blocks in the buffer.
 
-  // Allocate space for the result.
-  meta = alloc_cb->alloc(sizeof(ngf_plmd));
-  if (result == NULL) {
-    err = NGF_PLMD_ERROR_OUTOFMEM;
-    goto ngf_plmd_load_cleanup;
+  // The magic number doubles as a byte order mark.
+  const uint32_t magic_number = _load_field(buf, false);
+  if (magic_number == MAGIC_NUMBER) {
+    *swap = false;
+  } else if (magic_number == _bswap32(MAGIC_NUMBER)) {
+    *swap = true;
+  } else {
+    return NGF_PLMD_ERROR_MAGIC_NUMBER_MISMATCH;
   }
-  memset(meta, 0u, sizeof(ngf_plmd));
-  *result = meta;
 
-  // Create a copy of the metadata buffer.
-  meta->raw_data = alloc_cb->alloc(buf_size);
-  if (meta->raw_data == NULL) {
-    err = NGF_PLMD_ERROR_OUTOFMEM;
-    goto ngf_plmd_load_cleanup;
+  *version_maj = _load_field(buf + offsetof(ngf_plmd_header, version_maj), *swap);
+  switch (*version_maj) {
+  case NGF_PLMD_LEGACY_VERSION_MAJ:
+    return _read_legacy_header(buf, buf_size, *swap, counts);
+  case NGF_PLMD_NATIVE_VERSION_MAJ:
+    return _read_native_header(buf, buf_size, *swap, counts);
+  default:
+    return NGF_PLMD_ERROR_UNSUPPORTED_VERSION;
   }
-  memcpy(meta->raw_data, buf, buf_size);
+}
 
-  // Convert each field from network to host byte order, but skip
-  // over raw byte blocks.
-  uint32_t *fields = (uint32_t*)meta->raw_data;
-  for (uint32_t field_idx = 0u; field_idx < nfields; ++field_idx) {
+static size_t _index_size(const _plmd_index_counts *counts) {
+  return sizeof(ngf_plmd) +
+         ((size_t)counts->nsets + counts->nimage_cis_entries +
+          counts->nsampler_cis_entries + counts->nnative_binding_sets) * sizeof(void*) +
+         (size_t)counts->nuser_entries * sizeof(ngf_plmd_user_entry) +
+         (size_t)counts->ninterface_vars * sizeof(ngf_plmd_interface_var) +
+         (size_t)counts->nblocks * sizeof(ngf_plmd_block_layout) +
+         (size_t)counts->nblock_members * sizeof(ngf_plmd_block_member);
+}
+
+// Carves the index arrays out of the memory following the ngf_plmd object.
+static void _assign_index_storage(ngf_plmd *meta,
+                                  const _plmd_index_counts *counts) {
+  uint8_t *storage = (uint8_t*)meta + sizeof(ngf_plmd);
+  meta->layout.set_layouts = (const ngf_plmd_descriptor_set_layout**)storage;
+  storage += counts->nsets * sizeof(void*);
+  meta->images_to_cis_map.entries = (const ngf_plmd_cis_map_entry**)storage;
+  storage += counts->nimage_cis_entries * sizeof(void*);
+  meta->samplers_to_cis_map.entries = (const ngf_plmd_cis_map_entry**)storage;
+  storage += counts->nsampler_cis_entries * sizeof(void*);
+  meta->native_binding_map.sets = (const ngf_plmd_native_binding_set**)storage;
+  storage += counts->nnative_binding_sets * sizeof(void*);
+  meta->user.entries = (ngf_plmd_user_entry*)storage;
+  storage += counts->nuser_entries * sizeof(ngf_plmd_user_entry);
+  meta->interface_vars.vars = (ngf_plmd_interface_var*)storage;
+  storage += counts->ninterface_vars * sizeof(ngf_plmd_interface_var);
+  meta->block_layouts.blocks = (ngf_plmd_block_layout*)storage;
+}
+
+// Converts a legacy metadata buffer to host byte order, skipping over raw byte
+// blocks. The header never contains any raw byte blocks.
+static ngf_plmd_error _swap_legacy(uint8_t *data, size_t size) {
+  uint32_t *fields = (uint32_t*)data;
+  const uint32_t nfields = (uint32_t)(size >> 2u);
+  const uint32_t nheader_fields = sizeof(ngf_plmd_header) / sizeof(uint32_t);
+  _swap_fields(data, nheader_fields);
+  for (uint32_t field_idx = nheader_fields; field_idx < nfields; ++field_idx) {
     const uint32_t field_value = fields[field_idx];
     if (field_value == START_OF_RAW_BYTE_BLOCK) {
       if (field_idx >= nfields - 1u) {
-        err = NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
-        goto ngf_plmd_load_cleanup;
+        return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
       }
       field_idx += 1u; // skip over the raw byte block start mark.
-      // Convert the length of raw byte block from network to host byte order,
-      // and write it back to the buffer.
-      const uint32_t raw_blk_size = ntohl(fields[field_idx]);
+      // Convert the length of raw byte block to host byte order, and write
+      // it back to the buffer.
+      const uint32_t raw_blk_size = _bswap32(fields[field_idx]);
       fields[field_idx] = raw_blk_size;
+      if (raw_blk_size >= nfields - field_idx) {
+        break;
+      }
       field_idx += raw_blk_size; // skip over the raw byte block contents.
     } else {
-      fields[field_idx] = ntohl(field_value);
+      fields[field_idx] = _bswap32(field_value);
     }
   }
+  return NGF_PLMD_ERROR_OK;
+}
 
-  // Process header.
-  meta->header = (const ngf_plmd_header*)meta->raw_data;
-  const ngf_plmd_header *header = meta->header;
-  if (header->magic_number != MAGIC_NUMBER) {
-    err = NGF_PLMD_ERROR_MAGIC_NUMBER_MISMATCH;
-    goto ngf_plmd_load_cleanup;
+// Converts a native metadata buffer to host byte order. Every section other
+// than the string table consists only of fields. The section table has already
+// been validated by _read_native_header.
+static void _swap_native(uint8_t *data) {
+  const size_t nheader_fields =
+      sizeof(ngf_plmd_native_header) / sizeof(uint32_t);
+  _swap_fields(data, nheader_fields);
+  const ngf_plmd_native_header *header = (const ngf_plmd_native_header*)data;
+  _swap_fields(data + sizeof(ngf_plmd_native_header),
+               header->nsections * sizeof(ngf_plmd_section) / sizeof(uint32_t));
+  for (uint32_t s = 0u; s < header->nsections; ++s) {
+    const ngf_plmd_section *section = &header->sections[s];
+    if (s != NGF_PLMD_SECTION_STRING_TABLE) {
+      _swap_fields(data + section->offset, section->size / sizeof(uint32_t));
+    }
   }
+}
 
-  // Sanity-check offsets in the header.
-  if (header->entrypoints_offset >= buf_size ||
-      header->pipeline_layout_offset >= buf_size ||
-      header->image_to_cis_map_offset >= buf_size ||
-      header->sampler_to_cis_map_offset >= buf_size ||
-      header->user_metadata_offset >= buf_size ||
-      header->threadgroup_size_offset >= buf_size) {
-    err = NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
-    goto ngf_plmd_load_cleanup;
+static ngf_plmd_error _index_cis_map(_plmd_reader r, uint32_t nentries,
+                                     ngf_plmd_cis_map *map) {
+  map->nentries = *_read_fields(&r, 1u);
+  if (map->nentries != nentries) {
+    return NGF_PLMD_ERROR_MALFORMED_RECORD;
+  }
+  for (uint32_t e = 0u; e < map->nentries; ++e) {
+    const ngf_plmd_cis_map_entry *entry =
+        (const ngf_plmd_cis_map_entry*)_read_fields(&r, 3u);
+    if (entry == NULL || _read_fields(&r, entry->ncombined_ids) == NULL) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    map->entries[e] = entry;
   }
+  return NGF_PLMD_ERROR_OK;
+}
+
+// Builds the index for a legacy metadata buffer in host byte order, validating
+// the bounds of every record along the way. The counts stored in the records
+// must match the ones the index storage was sized for.
+static ngf_plmd_error _index_legacy_records(ngf_plmd *meta, const uint8_t *data,
+                                            size_t size,
+                                            const _plmd_index_counts *counts) {
+  ngf_plmd_error err = NGF_PLMD_ERROR_OK;
+  const uint8_t *end = data + size;
+  meta->header = (const ngf_plmd_header*)data;
+  const ngf_plmd_header *header = meta->header;
 
   // Process the entrypoints record.
-  const uint8_t *entrypoints_ptr =
-      &meta->raw_data[header->entrypoints_offset];
-  const uint32_t nentrypoints = *(const uint32_t*)entrypoints_ptr;
-  entrypoints_ptr += sizeof(uint32_t);
-  for (uint32_t ep = 0u; ep < nentrypoints; ++ep) {
-    const uint32_t kind = *(const uint32_t*)entrypoints_ptr;
-    entrypoints_ptr += 2u * sizeof(uint32_t);
-    const uint32_t size = *(const uint32_t*)entrypoints_ptr;
-    entrypoints_ptr += sizeof(uint32_t);
-    const char *name = (const char*)entrypoints_ptr;
-    entrypoints_ptr += size * sizeof(uint32_t);
-    if (kind == 0) meta->entrypoints.vert_shader_entrypoint = name;
-    else if (kind == 1) meta->entrypoints.frag_shader_entrypoint = name;
-    else if (kind == 2) meta->entrypoints.compute_shader_entrypoint = name;
-    else {
-      err = NGF_PLMD_ERROR_INVALID_SHADER_STAGE;
-      goto ngf_plmd_load_cleanup;
+  _plmd_reader r = { data + header->entrypoints_offset, end };
+  const uint32_t *nentrypoints = _read_fields(&r, 1u);
+  for (uint32_t ep = 0u; ep < *nentrypoints; ++ep) {
+    const uint32_t *kind = _read_fields(&r, 1u);
+    const char *name = NULL;
+    if (kind == NULL) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    if ((err = _read_string(&r, &name)) != NGF_PLMD_ERROR_OK ||
+        (err = _set_entrypoint(meta, *kind, name)) != NGF_PLMD_ERROR_OK) {
+      return err;
     }
   }
 
   // Process the pipeline layout record.
-  const uint8_t *pipeline_layout_ptr =
-      &meta->raw_data[header->pipeline_layout_offset];
-  const uint32_t nsets = *(const uint32_t*)pipeline_layout_ptr;
-  meta->layout.ndescriptor_sets = nsets;
-  meta->layout.set_layouts = alloc_cb->alloc(sizeof(void*) * nsets);
-  if (meta->layout.set_layouts == NULL) {
-    err = NGF_PLMD_ERROR_OUTOFMEM;
-    goto ngf_plmd_load_cleanup;
+  r = (_plmd_reader){ data + header->pipeline_layout_offset, end };
+  meta->layout.ndescriptor_sets = *_read_fields(&r, 1u);
+  if (meta->layout.ndescriptor_sets != counts->nsets) {
+    return NGF_PLMD_ERROR_MALFORMED_RECORD;
+  }
+  for (uint32_t s = 0u; s < meta->layout.ndescriptor_sets; ++s) {
+    const ngf_plmd_descriptor_set_layout *set =
+        (const ngf_plmd_descriptor_set_layout*)_read_fields(&r, 1u);
+    if (set == NULL ||
+        set->ndescriptors > UINT32_MAX / 3u ||
+        _read_fields(&r, set->ndescriptors * 3u) == NULL) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    meta->layout.set_layouts[s] = set;
+  }
+
+  // Process combined image/sampler maps.
+  err = _index_cis_map(
+      (_plmd_reader){ data + header->image_to_cis_map_offset, end },
+      counts->nimage_cis_entries,
+      &meta->images_to_cis_map);
+  if (err != NGF_PLMD_ERROR_OK) {
+    return err;
+  }
+  err = _index_cis_map(
+      (_plmd_reader){ data + header->sampler_to_cis_map_offset, end },
+      counts->nsampler_cis_entries,
+      &meta->samplers_to_cis_map);
+  if (err != NGF_PLMD_ERROR_OK) {
+    return err;
+  }
+
+  // Process user metadata.
+  r = (_plmd_reader){ data + header->user_metadata_offset, end };
+  meta->user.nentries = *_read_fields(&r, 1u);
+  if (meta->user.nentries != counts->nuser_entries) {
+    return NGF_PLMD_ERROR_MALFORMED_RECORD;
+  }
+  for (uint32_t e = 0u; e < meta->user.nentries; ++e) {
+    if ((err = _read_string(&r, &meta->user.entries[e].key)) != NGF_PLMD_ERROR_OK ||
+        (err = _read_string(&r, &meta->user.entries[e].value)) != NGF_PLMD_ERROR_OK) {
+      return err;
+    }
+  }
+
+  // Process threadgroup size.
+  r = (_plmd_reader){ data + header->threadgroup_size_offset, end };
+  meta->threadgroup_size = (const ngf_plmd_threadgroup_size*)_read_fields(&r, 3u);
+  if (meta->threadgroup_size == NULL) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
   }
-  const uint8_t *set_ptr = pipeline_layout_ptr + sizeof(uint32_t);
-  for (uint32_t s = 0u; s < nsets; ++s) {
-    meta->layout.set_layouts[s] = (const ngf_plmd_descriptor_set_layout*)set_ptr;
-    const size_t set_data_size =
-        meta->layout.set_layouts[s]->ndescriptors * sizeof(ngf_plmd_descriptor) +
-        sizeof(uint32_t);
-    set_ptr += set_data_size;
+
+  return NGF_PLMD_ERROR_OK;
+}
+
+static _plmd_reader _section_reader(const uint8_t *data,
+                                    const ngf_plmd_section *section) {
+  return (_plmd_reader){ data + section->offset,
+                         data + section->offset + section->size };
+}
+
+// Returns a reader positioned at an item of a section that starts with a table
+// of item offsets, or a reader with no data left if the offset is invalid.
+static _plmd_reader _section_item_reader(const uint8_t *data,
+                                         const ngf_plmd_section *section,
+                                         uint32_t item_offset) {
+  const uint8_t *end = data + section->offset + section->size;
+  if (item_offset > section->size || (item_offset & 0b11) != 0) {
+    return (_plmd_reader){ end, end };
+  }
+  return (_plmd_reader){ data + section->offset + item_offset, end };
+}
+
+static const char* _native_string(const char *strings, uint32_t strings_size,
+                                  uint32_t offset) {
+  return offset < strings_size ? strings + offset : NULL;
+}
+
+static ngf_plmd_error _index_native_cis_map(const uint8_t *data,
+                                            const ngf_plmd_section *section,
+                                            ngf_plmd_cis_map *map) {
+  _plmd_reader r = _section_reader(data, section);
+  const uint32_t *entry_offsets = _read_fields(&r, section->count);
+  map->nentries = section->count;
+  for (uint32_t e = 0u; e < map->nentries; ++e) {
+    r = _section_item_reader(data, section, entry_offsets[e]);
+    const ngf_plmd_cis_map_entry *entry =
+        (const ngf_plmd_cis_map_entry*)_read_fields(&r, 3u);
+    if (entry == NULL || _read_fields(&r, entry->ncombined_ids) == NULL) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    map->entries[e] = entry;
+  }
+  return NGF_PLMD_ERROR_OK;
+}
+
+// Builds the index for a native metadata buffer in host byte order. The
+// section table has already been validated by _read_native_header, and
+// the index storage sized from its counts.
+static ngf_plmd_error _index_native_sections(ngf_plmd *meta,
+                                             const uint8_t *data,
+                                             const _plmd_index_counts *counts) {
+  ngf_plmd_error err = NGF_PLMD_ERROR_OK;
+  meta->native_header = (const ngf_plmd_native_header*)data;
+  const ngf_plmd_section *sections = meta->native_header->sections;
+
+  // Synthesize the legacy header.
+  ngf_plmd_header *header = &meta->header_storage;
+  header->magic_number = meta->native_header->magic_number;
+  header->header_size = meta->native_header->header_size;
+  header->version_maj = meta->native_header->version_maj;
+  header->version_min = meta->native_header->version_min;
+  header->entrypoints_offset =
+      sections[NGF_PLMD_SECTION_ENTRYPOINTS].offset;
+  header->pipeline_layout_offset =
+      sections[NGF_PLMD_SECTION_PIPELINE_LAYOUT].offset;
+  header->image_to_cis_map_offset =
+      sections[NGF_PLMD_SECTION_IMAGE_TO_CIS_MAP].offset;
+  header->sampler_to_cis_map_offset =
+      sections[NGF_PLMD_SECTION_SAMPLER_TO_CIS_MAP].offset;
+  header->user_metadata_offset =
+      sections[NGF_PLMD_SECTION_USER_METADATA].offset;
+  header->threadgroup_size_offset =
+      sections[NGF_PLMD_SECTION_THREADGROUP_SIZE].offset;
+  meta->header = header;
+
+  // All strings are null-terminated, so any offset within a string table that
+  // ends with a null character yields a valid string.
+  const ngf_plmd_section *string_table = &sections[NGF_PLMD_SECTION_STRING_TABLE];
+  const char *strings = (const char*)data + string_table->offset;
+  if (string_table->size > 0u && strings[string_table->size - 1u] != '\0') {
+    return NGF_PLMD_ERROR_MALFORMED_RECORD;
+  }
+
+  // Process the entrypoints section.
+  const ngf_plmd_section *entrypoints = &sections[NGF_PLMD_SECTION_ENTRYPOINTS];
+  const ngf_plmd_native_entrypoint *eps =
+      (const ngf_plmd_native_entrypoint*)(data + entrypoints->offset);
+  if (entrypoints->count > entrypoints->size / sizeof(ngf_plmd_native_entrypoint)) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+  }
+  for (uint32_t ep = 0u; ep < entrypoints->count; ++ep) {
+    const char *name =
+        _native_string(strings, string_table->size, eps[ep].name_offset);
+    if (name == NULL) {
+      return NGF_PLMD_ERROR_MALFORMED_RECORD;
+    }
+    if ((err = _set_entrypoint(meta, eps[ep].stage, name)) != NGF_PLMD_ERROR_OK) {
+      return err;
+    }
+  }
+
+  // Process the pipeline layout section.
+  const ngf_plmd_section *layout = &sections[NGF_PLMD_SECTION_PIPELINE_LAYOUT];
+  _plmd_reader r = _section_reader(data, layout);
+  const uint32_t *set_offsets = _read_fields(&r, layout->count);
+  meta->layout.ndescriptor_sets = layout->count;
+  for (uint32_t s = 0u; s < meta->layout.ndescriptor_sets; ++s) {
+    r = _section_item_reader(data, layout, set_offsets[s]);
+    const ngf_plmd_descriptor_set_layout *set =
+        (const ngf_plmd_descriptor_set_layout*)_read_fields(&r, 1u);
+    if (set == NULL ||
+        set->ndescriptors > UINT32_MAX / 3u ||
+        _read_fields(&r, set->ndescriptors * 3u) == NULL) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    meta->layout.set_layouts[s] = set;
   }
 
   // Process combined image/sampler maps.
-  _create_cis_map((uint8_t*)meta->raw_data + header->image_to_cis_map_offset,
-                   alloc_cb,
-                   &meta->images_to_cis_map);
-  _create_cis_map((uint8_t*)meta->raw_data + header->sampler_to_cis_map_offset,
-                   alloc_cb,
-                   &meta->samplers_to_cis_map);
+  err = _index_native_cis_map(data, &sections[NGF_PLMD_SECTION_IMAGE_TO_CIS_MAP],
+                              &meta->images_to_cis_map);
+  if (err != NGF_PLMD_ERROR_OK) {
+    return err;
+  }
+  err = _index_native_cis_map(data, &sections[NGF_PLMD_SECTION_SAMPLER_TO_CIS_MAP],
+                              &meta->samplers_to_cis_map);
+  if (err != NGF_PLMD_ERROR_OK) {
+    return err;
+  }
 
   // Process user metadata.
-  meta->user.nentries = 
-      *(uint32_t*)&meta->raw_data[header->user_metadata_offset];
-  meta->user.entries =
-      alloc_cb->alloc(sizeof(ngf_plmd_user_entry) * meta->user.nentries);
-  if (meta->user.entries == NULL) {
+  const ngf_plmd_section *user = &sections[NGF_PLMD_SECTION_USER_METADATA];
+  const ngf_plmd_native_user_entry *user_entries =
+      (const ngf_plmd_native_user_entry*)(data + user->offset);
+  meta->user.nentries = user->count;
+  for (uint32_t e = 0u; e < meta->user.nentries; ++e) {
+    meta->user.entries[e].key =
+        _native_string(strings, string_table->size, user_entries[e].key_offset);
+    meta->user.entries[e].value =
+        _native_string(strings, string_table->size, user_entries[e].value_offset);
+    if (meta->user.entries[e].key == NULL || meta->user.entries[e].value == NULL) {
+      return NGF_PLMD_ERROR_MALFORMED_RECORD;
+    }
+  }
+
+  // Process threadgroup size.
+  r = _section_reader(data, &sections[NGF_PLMD_SECTION_THREADGROUP_SIZE]);
+  meta->threadgroup_size = (const ngf_plmd_threadgroup_size*)_read_fields(&r, 3u);
+  if (meta->threadgroup_size == NULL) {
+    return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+  }
+
+  // Process the native binding map, which files older than version 1.1 do not
+  // have. It starts with the native binding of push constants, followed by a
+  // table of the offsets of the sets within the section.
+  if (meta->native_header->nsections > NGF_PLMD_SECTION_NATIVE_BINDING_MAP) {
+    const ngf_plmd_section *binding_map =
+        &sections[NGF_PLMD_SECTION_NATIVE_BINDING_MAP];
+    r = _section_reader(data, binding_map);
+    const uint32_t *push_constants_binding = _read_fields(&r, 1u);
+    const uint32_t *set_offsets = _read_fields(&r, binding_map->count);
+    if (push_constants_binding == NULL || set_offsets == NULL) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    meta->native_binding_map.nsets = binding_map->count;
+    meta->native_binding_map.push_constants_native_binding = *push_constants_binding;
+    for (uint32_t s = 0u; s < meta->native_binding_map.nsets; ++s) {
+      r = _section_item_reader(data, binding_map, set_offsets[s]);
+      const ngf_plmd_native_binding_set *set =
+          (const ngf_plmd_native_binding_set*)_read_fields(&r, 1u);
+      if (set == NULL || _read_fields(&r, set->nbindings) == NULL) {
+        return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+      }
+      meta->native_binding_map.sets[s] = set;
+    }
+    meta->has_native_binding_map = true;
+  }
+
+  // Process descriptor counts, which files older than version 1.2 do not have.
+  // The counts for the whole pipeline are followed by the counts for each set.
+  if (meta->native_header->nsections > NGF_PLMD_SECTION_DESCRIPTOR_COUNTS) {
+    const ngf_plmd_section *descriptor_counts =
+        &sections[NGF_PLMD_SECTION_DESCRIPTOR_COUNTS];
+    const uint32_t item_fields =
+        (uint32_t)(sizeof(ngf_plmd_descriptor_counts) / sizeof(uint32_t));
+    if (descriptor_counts->count >= UINT32_MAX / item_fields) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    r = _section_reader(data, descriptor_counts);
+    const uint32_t *type_counts =
+        _read_fields(&r, (descriptor_counts->count + 1u) * item_fields);
+    if (type_counts == NULL) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    meta->descriptor_pool_sizes.total = (const ngf_plmd_descriptor_counts*)type_counts;
+    meta->descriptor_pool_sizes.sets = meta->descriptor_pool_sizes.total + 1u;
+    meta->descriptor_pool_sizes.nsets = descriptor_counts->count;
+  }
+
+  // Process interface variables, which files older than version 1.3 do not
+  // have. They must be sorted by stage and direction, so that the variables of
+  // a stage can be found as a contiguous range.
+  if (meta->native_header->nsections > NGF_PLMD_SECTION_INTERFACE_VARS) {
+    const ngf_plmd_section *interface_vars =
+        &sections[NGF_PLMD_SECTION_INTERFACE_VARS];
+    const ngf_plmd_native_interface_var *vars =
+        (const ngf_plmd_native_interface_var*)(data + interface_vars->offset);
+    meta->interface_vars.nvars = interface_vars->count;
+    for (uint32_t v = 0u; v < meta->interface_vars.nvars; ++v) {
+      if (vars[v].stage > 2u) {
+        return NGF_PLMD_ERROR_INVALID_SHADER_STAGE;
+      }
+      if (vars[v].direction > NGF_PLMD_INTERFACE_OUTPUT ||
+          (v > 0u && (vars[v].stage < vars[v - 1u].stage ||
+                      (vars[v].stage == vars[v - 1u].stage &&
+                       vars[v].direction < vars[v - 1u].direction)))) {
+        return NGF_PLMD_ERROR_MALFORMED_RECORD;
+      }
+      ngf_plmd_interface_var *var = &meta->interface_vars.vars[v];
+      var->name = _native_string(strings, string_table->size, vars[v].name_offset);
+      if (var->name == NULL) {
+        return NGF_PLMD_ERROR_MALFORMED_RECORD;
+      }
+      var->stage = vars[v].stage;
+      var->direction = vars[v].direction;
+      var->base_type = vars[v].base_type;
+      var->vecsize = vars[v].vecsize;
+      var->location = vars[v].location;
+    }
+    meta->has_interface_vars = true;
+  }
+
+  // Process block layouts, which files older than version 1.4 do not have. The
+  // section starts with the total number of block members, followed by a table
+  // of the offsets of the blocks within the section. Blocks must be sorted by
+  // set and binding, so that they can be looked up with a binary search.
+  if (meta->native_header->nsections > NGF_PLMD_SECTION_BLOCK_LAYOUTS) {
+    const ngf_plmd_section *block_layouts =
+        &sections[NGF_PLMD_SECTION_BLOCK_LAYOUTS];
+    r = _section_reader(data, block_layouts);
+    const uint32_t *nmembers_total = _read_fields(&r, 1u);
+    const uint32_t *block_offsets = _read_fields(&r, block_layouts->count);
+    if (nmembers_total == NULL || block_offsets == NULL) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    // The member storage was sized from the count read by _read_native_header.
+    if (*nmembers_total != counts->nblock_members) {
+      return NGF_PLMD_ERROR_MALFORMED_RECORD;
+    }
+    ngf_plmd_block_member *members =
+        (ngf_plmd_block_member*)(meta->block_layouts.blocks + block_layouts->count);
+    uint32_t nmembers_indexed = 0u;
+    meta->block_layouts.nblocks = block_layouts->count;
+    for (uint32_t b = 0u; b < meta->block_layouts.nblocks; ++b) {
+      r = _section_item_reader(data, block_layouts, block_offsets[b]);
+      const uint32_t *block_fields = _read_fields(&r, 4u);
+      if (block_fields == NULL) {
+        return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+      }
+      ngf_plmd_block_layout *block = &meta->block_layouts.blocks[b];
+      block->set = block_fields[0];
+      block->binding = block_fields[1];
+      block->size = block_fields[2];
+      block->nmembers = block_fields[3];
+      block->members = members + nmembers_indexed;
+      if (block->nmembers > *nmembers_total - nmembers_indexed ||
+          (b > 0u && (block->set < block[-1].set ||
+                      (block->set == block[-1].set && block->binding <= block[-1].binding)))) {
+        return NGF_PLMD_ERROR_MALFORMED_RECORD;
+      }
+      const ngf_plmd_native_block_member *native_members =
+          (const ngf_plmd_native_block_member*)_read_fields(
+              &r, block->nmembers * (uint32_t)(sizeof(ngf_plmd_native_block_member) /
+                                               sizeof(uint32_t)));
+      if (native_members == NULL) {
+        return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+      }
+      for (uint32_t m = 0u; m < block->nmembers; ++m) {
+        ngf_plmd_block_member *member = &members[nmembers_indexed++];
+        member->name =
+            _native_string(strings, string_table->size, native_members[m].name_offset);
+        if (member->name == NULL) {
+          return NGF_PLMD_ERROR_MALFORMED_RECORD;
+        }
+        member->offset = native_members[m].offset;
+        member->size = native_members[m].size;
+        member->vecsize = native_members[m].vecsize;
+        member->columns = native_members[m].columns;
+        member->array_size = native_members[m].array_size;
+        member->array_stride = native_members[m].array_stride;
+        member->matrix_stride = native_members[m].matrix_stride;
+        member->flags = native_members[m].flags;
+      }
+    }
+    meta->has_block_layouts = true;
+  }
+
+  // Process the descriptor index, which files older than version 1.5 do not
+  // have. It starts with the number of hash buckets, the number of hash slots
+  // and the number of binding tables, followed by the names of the
+  // descriptors, the displacement of each bucket, the descriptor in each slot
+  // and a table of the offsets of the binding tables within the section.
+  if (meta->native_header->nsections > NGF_PLMD_SECTION_DESCRIPTOR_INDEX) {
+    const ngf_plmd_section *descriptor_index =
+        &sections[NGF_PLMD_SECTION_DESCRIPTOR_INDEX];
+    _plmd_descriptor_index *index = &meta->descriptor_index;
+    r = _section_reader(data, descriptor_index);
+    const uint32_t *index_header = _read_fields(&r, 3u);
+    if (index_header == NULL ||
+        descriptor_index->count > UINT32_MAX / 4u) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    index->nbuckets = index_header[0];
+    index->nslots = index_header[1];
+    index->ntables = index_header[2];
+    index->names = (const ngf_plmd_native_descriptor_name*)_read_fields(
+        &r, descriptor_index->count * 4u);
+    index->displacements = _read_fields(&r, index->nbuckets);
+    index->slots = _read_fields(&r, index->nslots);
+    index->table_offsets = _read_fields(&r, index->ntables);
+    if (index->names == NULL || index->displacements == NULL ||
+        index->slots == NULL || index->table_offsets == NULL) {
+      return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+    }
+    if ((index->nslots > 0u && index->nbuckets == 0u) ||
+        index->ntables > meta->layout.ndescriptor_sets) {
+      return NGF_PLMD_ERROR_MALFORMED_RECORD;
+    }
+    index->section_data = data + descriptor_index->offset;
+    index->strings = strings;
+    // Validate everything that lookups rely on, so that they need no checks
+    // beyond comparing names.
+    for (uint32_t d = 0u; d < descriptor_index->count; ++d) {
+      const ngf_plmd_native_descriptor_name *name = &index->names[d];
+      if (name->set >= meta->layout.ndescriptor_sets ||
+          name->index >= meta->layout.set_layouts[name->set]->ndescriptors ||
+          _native_string(strings, string_table->size, name->name_offset) == NULL) {
+        return NGF_PLMD_ERROR_MALFORMED_RECORD;
+      }
+    }
+    for (uint32_t s = 0u; s < index->nslots; ++s) {
+      if (index->slots[s] != NGF_PLMD_NO_DESCRIPTOR &&
+          index->slots[s] >= descriptor_index->count) {
+        return NGF_PLMD_ERROR_MALFORMED_RECORD;
+      }
+    }
+    for (uint32_t t = 0u; t < index->ntables; ++t) {
+      r = _section_item_reader(data, descriptor_index, index->table_offsets[t]);
+      const ngf_plmd_native_descriptor_table *table =
+          (const ngf_plmd_native_descriptor_table*)_read_fields(&r, 1u);
+      if (table == NULL || _read_fields(&r, table->nbindings) == NULL) {
+        return NGF_PLMD_ERROR_BUFFER_TOO_SMALL;
+      }
+      const ngf_plmd_descriptor_set_layout *set = meta->layout.set_layouts[t];
+      for (uint32_t b = 0u; b < table->nbindings; ++b) {
+        const uint32_t i = table->indices[b];
+        if (i != NGF_PLMD_NO_DESCRIPTOR &&
+            (i >= descriptor_index->count || index->names[i].set != t ||
+             set->descriptors[index->names[i].index].binding != b)) {
+          return NGF_PLMD_ERROR_MALFORMED_RECORD;
+        }
+      }
+    }
+    meta->has_descriptor_index = true;
+  }
+
+  return NGF_PLMD_ERROR_OK;
+}
+
+static ngf_plmd_error _index(ngf_plmd *meta, const uint8_t *data, size_t size,
+                             uint32_t version_maj,
+                             const _plmd_index_counts *counts) {
+  meta->raw_data = data;
+  return version_maj == NGF_PLMD_NATIVE_VERSION_MAJ
+             ? _index_native_sections(meta, data, counts)
+             : _index_legacy_records(meta, data, size, counts);
+}
+
+ngf_plmd_error ngf_plmd_load(const void *buf, size_t buf_size,
+                     const ngf_plmd_alloc_callbacks *alloc_cb,
+                     ngf_plmd **result) {
+  ngf_plmd_error err = NGF_PLMD_ERROR_OK;
+  ngf_plmd *meta = NULL;
+  bool swap = false;
+  uint32_t version_maj = 0u;
+  _plmd_index_counts counts;
+  assert(buf);
+  assert(result);
+
+  // Use stdlib malloc/free by default.
+  if (alloc_cb == NULL) {
+    alloc_cb = &stdlib_alloc;
+  }
+
+  err = _read_header(buf, buf_size, &swap, &version_maj, &counts);
+  if (err != NGF_PLMD_ERROR_OK) {
+    goto ngf_plmd_load_cleanup;
+  }
+
+  // Allocate space for the result, its index and a copy of the metadata
+  // buffer all at once. The copy is kept 8-byte aligned, as native sections
+  // are.
+  const size_t index_size = (_index_size(&counts) + 7u) & ~(size_t)7u;
+  meta = alloc_cb->alloc(index_size + buf_size);
+  if (meta == NULL) {
     err = NGF_PLMD_ERROR_OUTOFMEM;
     goto ngf_plmd_load_cleanup;
   }
-  uint8_t *blk_ptr = &meta->raw_data[header->user_metadata_offset + 4u];
-  for (uint32_t e = 0u; e < meta->user.nentries; ++e) {
-    uint32_t *size_ptr = (uint32_t*)(blk_ptr + sizeof(uint32_t));
-    blk_ptr += 2 * sizeof(uint32_t);
-    meta->user.entries[e].key = (const char*)(blk_ptr);
-    blk_ptr += *size_ptr * sizeof(uint32_t);
+  memset(meta, 0u, sizeof(ngf_plmd));
+  _assign_index_storage(meta, &counts);
+  uint8_t *raw_data = (uint8_t*)meta + index_size;
+  memcpy(raw_data, buf, buf_size);
 
-    size_ptr = (uint32_t*)(blk_ptr + sizeof(uint32_t));
-    blk_ptr += 2 * sizeof(uint32_t);
-    meta->user.entries[e].value = (const char*)(blk_ptr);
-    blk_ptr += *size_ptr * sizeof(uint32_t);
+  // Convert the copy to host byte order if necessary.
+  if (swap) {
+    if (version_maj == NGF_PLMD_NATIVE_VERSION_MAJ) {
+      _swap_native(raw_data);
+    } else if ((err = _swap_legacy(raw_data, buf_size)) != NGF_PLMD_ERROR_OK) {
+      goto ngf_plmd_load_cleanup;
+    }
   }
 
-  meta->threadgroup_size =
-      (const ngf_plmd_threadgroup_size*)(meta->raw_data + header->threadgroup_size_offset);
+  err = _index(meta, raw_data, buf_size, version_maj, &counts);
 
 ngf_plmd_load_cleanup:
   if (err != NGF_PLMD_ERROR_OK) {
     ngf_plmd_destroy(meta, alloc_cb);
+    meta = NULL;
+  }
+  *result = meta;
+  return err;
+}
+
+ngf_plmd_error ngf_plmd_load_in_place(const void *buf, size_t buf_size,
+                                      const ngf_plmd_alloc_callbacks *alloc_cb,
+                                      ngf_plmd **result) {
+  ngf_plmd_error err = NGF_PLMD_ERROR_OK;
+  ngf_plmd *meta = NULL;
+  bool swap = false;
+  uint32_t version_maj = 0u;
+  _plmd_index_counts counts;
+  assert(buf);
+  assert(result);
+
+  // Use stdlib malloc/free by default.
+  if (alloc_cb == NULL) {
+    alloc_cb = &stdlib_alloc;
+  }
+
+  err = _read_header(buf, buf_size, &swap, &version_maj, &counts);
+  if (err != NGF_PLMD_ERROR_OK) {
+    goto ngf_plmd_load_in_place_cleanup;
+  }
+  if (swap) {
+    err = NGF_PLMD_ERROR_BYTE_ORDER_MISMATCH;
+    goto ngf_plmd_load_in_place_cleanup;
+  }
+
+  // Fields are read directly from the buffer, so it has to be suitably
+  // aligned.
+  const uintptr_t alignment_mask =
+      version_maj == NGF_PLMD_NATIVE_VERSION_MAJ ? 0b111 : 0b11;
+  if (((uintptr_t)buf & alignment_mask) != 0) {
+    err = NGF_PLMD_ERROR_MISALIGNED_BUFFER;
+    goto ngf_plmd_load_in_place_cleanup;
+  }
+
+  // Allocate space for the result and its index.
+  meta = alloc_cb->alloc(_index_size(&counts));
+  if (meta == NULL) {
+    err = NGF_PLMD_ERROR_OUTOFMEM;
+    goto ngf_plmd_load_in_place_cleanup;
+  }
+  memset(meta, 0u, sizeof(ngf_plmd));
+  _assign_index_storage(meta, &counts);
+
+  err = _index(meta, buf, buf_size, version_maj, &counts);
+
+ngf_plmd_load_in_place_cleanup:
+  if (err != NGF_PLMD_ERROR_OK) {
+    ngf_plmd_destroy(meta, alloc_cb);
+    meta = NULL;
   }
+  *result = meta;
   return err;
 }
 
@@ -242,21 +1030,8 @@ void ngf_plmd_destroy(ngf_plmd *m, const ngf_plmd_alloc_callbacks *alloc_cb) {
     alloc_cb = &stdlib_alloc;
   }
   if (m != NULL) {
-    if (m->raw_data != NULL) {
-      alloc_cb->free(m->raw_data);
-    }
-    if (m->layout.set_layouts != NULL) {
-      alloc_cb->free((void*)m->layout.set_layouts);
-    }
-    if (m->images_to_cis_map.entries != NULL) {
-      alloc_cb->free((void*)m->images_to_cis_map.entries);
-    }
-    if (m->samplers_to_cis_map.entries != NULL) {
-      alloc_cb->free((void*)m->samplers_to_cis_map.entries);
-    }
-    if (m->user.entries != NULL) {
-      alloc_cb->free((void*)m->user.entries);
-    }
+    // The index and, if present, the copy of the metadata buffer are stored
+    // in the same allocation as the object itself.
     alloc_cb->free(m);
   }
 }
@@ -285,6 +1060,171 @@ const ngf_plmd_header* ngf_plmd_get_header(const ngf_plmd *m) {
   return m->header;
 }
 
+const ngf_plmd_native_binding_map* ngf_plmd_get_native_binding_map(const ngf_plmd *m) {
+  return m->has_native_binding_map ? &m->native_binding_map : NULL;
+}
+
+uint32_t ngf_plmd_get_native_binding(const ngf_plmd *m, uint32_t set, uint32_t binding) {
+  const ngf_plmd_native_binding_map *map = ngf_plmd_get_native_binding_map(m);
+  if (map == NULL || set >= map->nsets || binding >= map->sets[set]->nbindings) {
+    return NGF_PLMD_NO_NATIVE_BINDING;
+  }
+  return map->sets[set]->native_bindings[binding];
+}
+
+const ngf_plmd_descriptor_pool_sizes* ngf_plmd_get_descriptor_pool_sizes(const ngf_plmd *m) {
+  return m->descriptor_pool_sizes.total != NULL ? &m->descriptor_pool_sizes : NULL;
+}
+
+const ngf_plmd_interface_vars* ngf_plmd_get_interface_vars(const ngf_plmd *m) {
+  return m->has_interface_vars ? &m->interface_vars : NULL;
+}
+
+const ngf_plmd_interface_var* ngf_plmd_find_interface_vars(const ngf_plmd *m,
+                                                           uint32_t stage,
+                                                           uint32_t direction,
+                                                           uint32_t *nvars) {
+  const ngf_plmd_interface_vars *vars = ngf_plmd_get_interface_vars(m);
+  *nvars = 0u;
+  if (vars == NULL) {
+    return NULL;
+  }
+  uint32_t first = 0u;
+  while (first < vars->nvars &&
+         (vars->vars[first].stage != stage || vars->vars[first].direction != direction)) {
+    ++first;
+  }
+  uint32_t last = first;
+  while (last < vars->nvars &&
+         vars->vars[last].stage == stage && vars->vars[last].direction == direction) {
+    ++last;
+  }
+  *nvars = last - first;
+  return *nvars > 0u ? &vars->vars[first] : NULL;
+}
+
+const ngf_plmd_block_layouts* ngf_plmd_get_block_layouts(const ngf_plmd *m) {
+  return m->has_block_layouts ? &m->block_layouts : NULL;
+}
+
+const ngf_plmd_block_layout* ngf_plmd_find_block_layout(const ngf_plmd *m,
+                                                        uint32_t set,
+                                                        uint32_t binding) {
+  const ngf_plmd_block_layouts *layouts = ngf_plmd_get_block_layouts(m);
+  if (layouts == NULL) {
+    return NULL;
+  }
+  uint32_t lo = 0u, hi = layouts->nblocks;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2u;
+    const ngf_plmd_block_layout *block = &layouts->blocks[mid];
+    if (block->set == set && block->binding == binding) {
+      return block;
+    }
+    if (block->set < set || (block->set == set && block->binding < binding)) {
+      lo = mid + 1u;
+    } else {
+      hi = mid;
+    }
+  }
+  return NULL;
+}
+
+const ngf_plmd_block_layout* ngf_plmd_get_push_constants_block(const ngf_plmd *m) {
+  return ngf_plmd_find_block_layout(m, NGF_PLMD_PUSH_CONSTANTS_SET,
+                                    NGF_PLMD_PUSH_CONSTANTS_BINDING);
+}
+
+uint32_t ngf_plmd_hash_name(const char *name, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (const uint8_t *c = (const uint8_t*)name; *c != '\0'; ++c) {
+    hash = (hash ^ *c) * 16777619u;
+  }
+  // Mix the result, so that every bit of the seed affects every bit of the
+  // hash.
+  hash ^= hash >> 16u;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13u;
+  hash *= 0xc2b2ae35u;
+  hash ^= hash >> 16u;
+  return hash;
+}
+
+const ngf_plmd_descriptor* ngf_plmd_find_descriptor_by_name(const ngf_plmd *m,
+                                                           const char *name,
+                                                           uint32_t *set) {
+  const _plmd_descriptor_index *index = &m->descriptor_index;
+  if (!m->has_descriptor_index || index->nslots == 0u) {
+    return NULL;
+  }
+  // The bucket of the name determines the seed that maps it to its slot.
+  const uint32_t hash = ngf_plmd_hash_name(name, 0u);
+  const uint32_t displacement = index->displacements[hash % index->nbuckets];
+  const uint32_t slot =
+      index->slots[ngf_plmd_hash_name(name, displacement) % index->nslots];
+  if (slot == NGF_PLMD_NO_DESCRIPTOR) {
+    return NULL;
+  }
+  // Names that are not in the table may still map to an occupied slot.
+  const ngf_plmd_native_descriptor_name *entry = &index->names[slot];
+  if (entry->name_hash != hash ||
+      strcmp(index->strings + entry->name_offset, name) != 0) {
+    return NULL;
+  }
+  if (set != NULL) {
+    *set = entry->set;
+  }
+  return &m->layout.set_layouts[entry->set]->descriptors[entry->index];
+}
+
+// Finds the entry of the descriptor index for the given set and binding.
+static const ngf_plmd_native_descriptor_name*
+_find_indexed_descriptor(const ngf_plmd *m, uint32_t set, uint32_t binding) {
+  const _plmd_descriptor_index *index = &m->descriptor_index;
+  if (!m->has_descriptor_index || set >= index->ntables) {
+    return NULL;
+  }
+  const ngf_plmd_native_descriptor_table *table =
+      (const ngf_plmd_native_descriptor_table*)(index->section_data +
+                                                index->table_offsets[set]);
+  if (binding >= table->nbindings ||
+      table->indices[binding] == NGF_PLMD_NO_DESCRIPTOR) {
+    return NULL;
+  }
+  return &index->names[table->indices[binding]];
+}
+
+const ngf_plmd_descriptor* ngf_plmd_find_descriptor_by_binding(const ngf_plmd *m,
+                                                              uint32_t set,
+                                                              uint32_t binding) {
+  if (set >= m->layout.ndescriptor_sets) {
+    return NULL;
+  }
+  const ngf_plmd_descriptor_set_layout *set_layout = m->layout.set_layouts[set];
+  if (m->has_descriptor_index) {
+    const ngf_plmd_native_descriptor_name *entry =
+        _find_indexed_descriptor(m, set, binding);
+    return entry != NULL ? &set_layout->descriptors[entry->index] : NULL;
+  }
+  for (uint32_t d = 0u; d < set_layout->ndescriptors; ++d) {
+    if (set_layout->descriptors[d].binding == binding) {
+      return &set_layout->descriptors[d];
+    }
+  }
+  return NULL;
+}
+
+const char* ngf_plmd_get_descriptor_name(const ngf_plmd *m, uint32_t set,
+                                         uint32_t binding) {
+  const ngf_plmd_native_descriptor_name *entry =
+      _find_indexed_descriptor(m, set, binding);
+  return entry != NULL ? m->descriptor_index.strings + entry->name_offset : NULL;
+}
+
+const ngf_plmd_native_header* ngf_plmd_get_native_header(const ngf_plmd *m) {
+  return m->native_header;
+}
+
 const ngf_plmd_entrypoints* ngf_plmd_get_entrypoints(const ngf_plmd* m) {
   return &m->entrypoints;
 }
@@ -296,7 +1236,11 @@ const char* ngf_plmd_get_error_name(const ngf_plmd_error err) {
     "MAGIC_NUMBER_MISMATCH",
     "BUFFER_TOO_SMALL",
     "WEIRD_BUFFER_SIZE",
-    "INVALID_SHADER_STAGE"
+    "INVALID_SHADER_STAGE",
+    "MISALIGNED_BUFFER",
+    "BYTE_ORDER_MISMATCH",
+    "MALFORMED_RECORD",
+    "UNSUPPORTED_VERSION"
   };
   return ngf_plmd_error_names[err];
 }
@@ -49,8 +49,117 @@ typedef struct ngf_plmd ngf_plmd;
 #define NGF_PLMD_STAGE_VISIBILITY_FRAGMENT_BIT (0x02)
 #define NGF_PLMD_STAGE_VISIBILITY_COMPUTE_BIT  (0x04)
 
+/**
+ * Base types of interface variables.
+ */
+#define NGF_PLMD_BASE_TYPE_UNKNOWN        (0x00)
+#define NGF_PLMD_BASE_TYPE_VOID           (0x01)
+#define NGF_PLMD_BASE_TYPE_BOOLEAN        (0x02)
+#define NGF_PLMD_BASE_TYPE_SBYTE          (0x03)
+#define NGF_PLMD_BASE_TYPE_UBYTE          (0x04)
+#define NGF_PLMD_BASE_TYPE_SHORT          (0x05)
+#define NGF_PLMD_BASE_TYPE_USHORT         (0x06)
+#define NGF_PLMD_BASE_TYPE_INT            (0x07)
+#define NGF_PLMD_BASE_TYPE_UINT           (0x08)
+#define NGF_PLMD_BASE_TYPE_INT64          (0x09)
+#define NGF_PLMD_BASE_TYPE_UINT64         (0x0a)
+#define NGF_PLMD_BASE_TYPE_ATOMIC_COUNTER (0x0b)
+#define NGF_PLMD_BASE_TYPE_HALF           (0x0c)
+#define NGF_PLMD_BASE_TYPE_FLOAT          (0x0d)
+#define NGF_PLMD_BASE_TYPE_DOUBLE         (0x0e)
+#define NGF_PLMD_BASE_TYPE_STRUCT         (0x0f)
+#define NGF_PLMD_BASE_TYPE_COUNT          (0x10)
+
+/**
+ * Directions of interface variables.
+ */
+#define NGF_PLMD_INTERFACE_INPUT  (0x00)
+#define NGF_PLMD_INTERFACE_OUTPUT (0x01)
+
+/**
+ * Major version of the legacy pipeline metadata format, which stores records
+ * of 4-byte fields in network byte order, with strings embedded in raw byte
+ * blocks.
+ */
+#define NGF_PLMD_LEGACY_VERSION_MAJ (0u)
+
+/**
+ * Major version of the native pipeline metadata format, which is little-endian
+ * and consists of 8-byte aligned sections located through a section table.
+ */
+#define NGF_PLMD_NATIVE_VERSION_MAJ (1u)
+
+/**
+ * Minor version of the native pipeline metadata format written by niceshade.
+ * Each minor version appends sections to the ones defined by the previous one.
+ */
+#define NGF_PLMD_NATIVE_VERSION_MIN (5u)
+
+/**
+ * Section identifiers for the native pipeline metadata format. A section's
+ * identifier is its index in the section table.
+ */
+#define NGF_PLMD_SECTION_ENTRYPOINTS        (0x00)
+#define NGF_PLMD_SECTION_PIPELINE_LAYOUT    (0x01)
+#define NGF_PLMD_SECTION_IMAGE_TO_CIS_MAP   (0x02)
+#define NGF_PLMD_SECTION_SAMPLER_TO_CIS_MAP (0x03)
+#define NGF_PLMD_SECTION_USER_METADATA      (0x04)
+#define NGF_PLMD_SECTION_THREADGROUP_SIZE   (0x05)
+#define NGF_PLMD_SECTION_STRING_TABLE       (0x06)
+#define NGF_PLMD_SECTION_NATIVE_BINDING_MAP (0x07) /**< since version 1.1 */
+#define NGF_PLMD_SECTION_DESCRIPTOR_COUNTS  (0x08) /**< since version 1.2 */
+#define NGF_PLMD_SECTION_INTERFACE_VARS     (0x09) /**< since version 1.3 */
+#define NGF_PLMD_SECTION_BLOCK_LAYOUTS      (0x0a) /**< since version 1.4 */
+#define NGF_PLMD_SECTION_DESCRIPTOR_INDEX   (0x0b) /**< since version 1.5 */
+#define NGF_PLMD_SECTION_COUNT              (0x0c)
+
+/**
+ * Number of sections defined by version 1.0 of the native format, which all
+ * native files contain. Sections added by later minor versions may be missing
+ * from older files.
+ */
+#define NGF_PLMD_REQUIRED_SECTION_COUNT (0x07)
+
+/**
+ * Native binding of descriptors that have none, and of push constants in
+ * pipelines that do not use them.
+ */
+#define NGF_PLMD_NO_NATIVE_BINDING (0xffffffffu)
+
+/**
+ * Location of interface variables that have no location decoration, such as
+ * built-ins.
+ */
+#define NGF_PLMD_NO_LOCATION (0xffffffffu)
+
+/**
+ * Set and binding of the push constant block in the block layouts.
+ */
+#define NGF_PLMD_PUSH_CONSTANTS_SET     (0xffffffffu)
+#define NGF_PLMD_PUSH_CONSTANTS_BINDING (0xffffffffu)
+
+/**
+ * Array size of block members that are arrays whose size is not known at
+ * compile time, such as runtime-sized arrays.
+ */
+#define NGF_PLMD_UNSIZED_ARRAY (0xffffffffu)
+
+/**
+ * Marks unused slots of the descriptor name hash table, and bindings with no
+ * descriptor in the descriptor index.
+ */
+#define NGF_PLMD_NO_DESCRIPTOR (0xffffffffu)
+
+/**
+ * Flags of block members.
+ */
+#define NGF_PLMD_BLOCK_MEMBER_ROW_MAJOR_BIT (0x01)
+
 /**
  * Pipeline metadata header.
+ *
+ * For files in the native format, this header is not stored in the file, but
+ * synthesized from the section table.
  */
 typedef struct ngf_plmd_header {
   uint32_t magic_number; /**< must always be 0xdeadbeef */
@@ -99,6 +208,98 @@ typedef struct ngf_plmd_header {
   uint32_t threadgroup_size_offset;
 } ngf_plmd_header;
 
+/**
+ * An entry in the section table of a native pipeline metadata file.
+ */
+typedef struct ngf_plmd_section {
+  /**
+   * Offset, in bytes, from the beginning of the file, at which the section is
+   * stored. Always a multiple of 8.
+   */
+  uint32_t offset;
+  uint32_t size;     /**< Size of the section in bytes. */
+  uint32_t count;    /**< Number of items stored in the section. */
+  uint32_t reserved; /**< Always zero. */
+} ngf_plmd_section;
+
+/**
+ * Header of a native pipeline metadata file, followed by the section table.
+ */
+typedef struct ngf_plmd_native_header {
+  uint32_t magic_number; /**< must always be 0xdeadbeef */
+  uint32_t header_size;  /**< size of the header, including the section table. */
+  uint32_t version_maj;  /**< always NGF_PLMD_NATIVE_VERSION_MAJ. */
+  uint32_t version_min;  /**< minor version of the format in use. */
+  uint32_t nsections;    /**< number of entries in the section table. */
+  uint32_t reserved;     /**< always zero. */
+  ngf_plmd_section sections[];
+} ngf_plmd_native_header;
+
+/**
+ * An item of the ENTRYPOINTS section in a native pipeline metadata file.
+ */
+typedef struct ngf_plmd_native_entrypoint {
+  uint32_t stage;       /**< 0 - vertex, 1 - fragment, 2 - compute. */
+  uint32_t name_offset; /**< Offset of the name within the STRING_TABLE section. */
+} ngf_plmd_native_entrypoint;
+
+/**
+ * An item of the USER_METADATA section in a native pipeline metadata file.
+ */
+typedef struct ngf_plmd_native_user_entry {
+  uint32_t key_offset;   /**< Offset of the key within the STRING_TABLE section. */
+  uint32_t value_offset; /**< Offset of the value within the STRING_TABLE section. */
+} ngf_plmd_native_user_entry;
+
+/**
+ * An item of the INTERFACE_VARS section in a native pipeline metadata file.
+ */
+typedef struct ngf_plmd_native_interface_var {
+  uint32_t stage;       /**< 0 - vertex, 1 - fragment, 2 - compute. */
+  uint32_t direction;   /**< NGF_PLMD_INTERFACE_INPUT or NGF_PLMD_INTERFACE_OUTPUT. */
+  uint32_t name_offset; /**< Offset of the name within the STRING_TABLE section. */
+  uint32_t base_type;   /**< NGF_PLMD_BASE_TYPE_... */
+  uint32_t vecsize;     /**< Number of vector components. */
+  uint32_t location;    /**< Location, or NGF_PLMD_NO_LOCATION. */
+} ngf_plmd_native_interface_var;
+
+/**
+ * A block member in the BLOCK_LAYOUTS section of a native pipeline metadata
+ * file.
+ */
+typedef struct ngf_plmd_native_block_member {
+  uint32_t name_offset;   /**< Offset of the name within the STRING_TABLE section. */
+  uint32_t offset;        /**< Offset from the start of the block in bytes. */
+  uint32_t size;          /**< Size in bytes, 0 for unsized arrays. */
+  uint32_t vecsize;       /**< Number of vector components (rows, for matrices). */
+  uint32_t columns;       /**< Number of matrix columns, 1 for non-matrices. */
+  uint32_t array_size;    /**< 0 if not an array, or NGF_PLMD_UNSIZED_ARRAY. */
+  uint32_t array_stride;  /**< Distance between array elements in bytes. */
+  uint32_t matrix_stride; /**< Distance between matrix columns (or rows) in bytes. */
+  uint32_t flags;         /**< NGF_PLMD_BLOCK_MEMBER_..._BIT */
+} ngf_plmd_native_block_member;
+
+/**
+ * A descriptor in the DESCRIPTOR_INDEX section of a native pipeline metadata
+ * file.
+ */
+typedef struct ngf_plmd_native_descriptor_name {
+  uint32_t set;         /**< Descriptor set. */
+  uint32_t index;       /**< Index of the descriptor within the set layout. */
+  uint32_t name_offset; /**< Offset of the name within the STRING_TABLE section. */
+  uint32_t name_hash;   /**< ngf_plmd_hash_name(name, 0). */
+} ngf_plmd_native_descriptor_name;
+
+/**
+ * The descriptors of a set in the DESCRIPTOR_INDEX section of a native pipeline
+ * metadata file, indexed by binding.
+ */
+typedef struct ngf_plmd_native_descriptor_table {
+  uint32_t nbindings; /**< One past the largest binding in the set. */
+  uint32_t indices[]; /**< Index of the descriptor within the section, or
+                           NGF_PLMD_NO_DESCRIPTOR. */
+} ngf_plmd_native_descriptor_table;
+
 typedef struct ngf_plmd_entrypoints {
   const char* vert_shader_entrypoint;
   const char* frag_shader_entrypoint;
@@ -167,6 +368,121 @@ typedef struct ngf_plmd_cis_map {
   uint32_t                       nentries; /**< Number of entries in the map. */
 } ngf_plmd_cis_map;
 
+/**
+ * Native bindings of the descriptors in a descriptor set, indexed by binding.
+ */
+typedef struct ngf_plmd_native_binding_set {
+  uint32_t nbindings;         /**< One past the largest binding in the set. */
+  uint32_t native_bindings[]; /**< Native binding of each binding in the set,
+                                   or NGF_PLMD_NO_NATIVE_BINDING. */
+} ngf_plmd_native_binding_set;
+
+/**
+ * Targets without descriptor sets, like OpenGL and Metal, use a flat binding
+ * model. This maps each (set, binding) pair to the binding that the generated
+ * code for such targets uses. The map is shared by all targets a technique was
+ * compiled for.
+ */
+typedef struct ngf_plmd_native_binding_map {
+  const ngf_plmd_native_binding_set** sets; /**< Indexed by set. */
+  uint32_t                            nsets; /**< Number of descriptor sets. */
+  /**
+   * Native binding of the push constant block, or NGF_PLMD_NO_NATIVE_BINDING.
+   */
+  uint32_t push_constants_native_binding;
+} ngf_plmd_native_binding_map;
+
+/**
+ * Number of descriptors of each type. Each element of an array of descriptors
+ * counts as a separate descriptor.
+ *
+ * Arrays whose size is not known at compile time (runtime-sized arrays, and
+ * arrays sized by a specialization constant) are not included in the counts.
+ * Instead, the bit corresponding to their type is set in `unbounded_types`, and
+ * the application has to add the number of descriptors it actually uses.
+ */
+typedef struct ngf_plmd_descriptor_counts {
+  uint32_t counts[NGF_PLMD_DESC_NUM_TYPES]; /**< Indexed by NGF_PLMD_DESC_... */
+  /**
+   * Bit `1 << NGF_PLMD_DESC_...` is set if arrays of unknown size of the
+   * corresponding type are used.
+   */
+  uint32_t unbounded_types;
+} ngf_plmd_descriptor_counts;
+
+/**
+ * Precomputed descriptor counts of a pipeline, which can be used to size
+ * descriptor pools without walking the pipeline layout.
+ */
+typedef struct ngf_plmd_descriptor_pool_sizes {
+  const ngf_plmd_descriptor_counts* total; /**< Counts over all sets. */
+  const ngf_plmd_descriptor_counts* sets;  /**< Counts for each set. */
+  uint32_t                          nsets; /**< Number of descriptor sets. */
+} ngf_plmd_descriptor_pool_sizes;
+
+/**
+ * A variable used as an input or output of a pipeline stage.
+ */
+typedef struct ngf_plmd_interface_var {
+  const char* name;      /**< Name of the variable, or of the built-in. */
+  uint32_t    stage;     /**< 0 - vertex, 1 - fragment, 2 - compute. */
+  uint32_t    direction; /**< NGF_PLMD_INTERFACE_INPUT or NGF_PLMD_INTERFACE_OUTPUT. */
+  uint32_t    base_type; /**< NGF_PLMD_BASE_TYPE_... */
+  uint32_t    vecsize;   /**< Number of vector components. */
+  uint32_t    location;  /**< Location, or NGF_PLMD_NO_LOCATION. */
+} ngf_plmd_interface_var;
+
+/**
+ * Interface variables of all pipeline stages, sorted by stage, then by
+ * direction, then by location.
+ */
+typedef struct ngf_plmd_interface_vars {
+  ngf_plmd_interface_var* vars;
+  uint32_t                nvars; /**< Number of variables. */
+} ngf_plmd_interface_vars;
+
+/**
+ * A member of a uniform buffer, storage buffer or push constant block. Members
+ * of nested structures follow the structure itself, and are named like
+ * "outer.inner". For arrays of structures, the members of the first element are
+ * given, named like "outer[0].inner".
+ */
+typedef struct ngf_plmd_block_member {
+  const char* name;
+  uint32_t    offset;        /**< Offset from the start of the block in bytes. */
+  uint32_t    size;          /**< Size in bytes, 0 for unsized arrays. */
+  uint32_t    vecsize;       /**< Number of vector components (rows, for matrices). */
+  uint32_t    columns;       /**< Number of matrix columns, 1 for non-matrices. */
+  uint32_t    array_size;    /**< 0 if not an array, or NGF_PLMD_UNSIZED_ARRAY. */
+  uint32_t    array_stride;  /**< Distance between array elements in bytes. */
+  uint32_t    matrix_stride; /**< Distance between matrix columns (or rows) in bytes. */
+  uint32_t    flags;         /**< NGF_PLMD_BLOCK_MEMBER_..._BIT */
+} ngf_plmd_block_member;
+
+/**
+ * Memory layout of a uniform buffer, storage buffer or push constant block.
+ */
+typedef struct ngf_plmd_block_layout {
+  uint32_t set;     /**< Descriptor set, or NGF_PLMD_PUSH_CONSTANTS_SET. */
+  uint32_t binding; /**< Binding, or NGF_PLMD_PUSH_CONSTANTS_BINDING. */
+  /**
+   * Size of the block in bytes. For blocks ending with an unsized array, this
+   * excludes the array.
+   */
+  uint32_t                     size;
+  uint32_t                     nmembers; /**< Number of members. */
+  const ngf_plmd_block_member* members;  /**< Members, in order of their offsets. */
+} ngf_plmd_block_layout;
+
+/**
+ * Memory layouts of all blocks used by a pipeline, sorted by set and binding.
+ * The push constant block, if any, comes last.
+ */
+typedef struct ngf_plmd_block_layouts {
+  ngf_plmd_block_layout* blocks;
+  uint32_t               nblocks; /**< Number of blocks. */
+} ngf_plmd_block_layouts;
+
 /**
  * A user-provided metadata entry.
  */
@@ -196,7 +512,11 @@ typedef enum ngf_plmd_error {
   NGF_PLMD_ERROR_MAGIC_NUMBER_MISMATCH,
   NGF_PLMD_ERROR_BUFFER_TOO_SMALL,
   NGF_PLMD_ERROR_WEIRD_BUFFER_SIZE,
-  NGF_PLMD_ERROR_INVALID_SHADER_STAGE
+  NGF_PLMD_ERROR_INVALID_SHADER_STAGE,
+  NGF_PLMD_ERROR_MISALIGNED_BUFFER,
+  NGF_PLMD_ERROR_BYTE_ORDER_MISMATCH,
+  NGF_PLMD_ERROR_MALFORMED_RECORD,
+  NGF_PLMD_ERROR_UNSUPPORTED_VERSION
 } ngf_plmd_error;
 
 typedef struct ngf_plmd_alloc_callbacks {
@@ -204,11 +524,37 @@ typedef struct ngf_plmd_alloc_callbacks {
   void (*free)(void*);
 } ngf_plmd_alloc_callbacks;
 
+/**
+ * Loads pipeline metadata from the given buffer. The contents of the buffer are
+ * copied and converted to host byte order, so the buffer may be released as
+ * soon as this function returns. The copy and the index built over it are
+ * stored in a single allocation made with `alloc_cb` (or stdlib malloc, if
+ * `alloc_cb` is NULL).
+ */
 ngf_plmd_error ngf_plmd_load(
     const void*                     buf,
     size_t                          buf_size,
     const ngf_plmd_alloc_callbacks* alloc_cb,
     ngf_plmd**                      result);
+
+/**
+ * Loads pipeline metadata without copying the given buffer. The only memory
+ * allocated is a single block holding the result and the index arrays, sized
+ * from the counts stored at the beginning of each record. The bounds of every
+ * record are validated in a single pass over the buffer.
+ *
+ * The buffer, which may be a memory-mapped file, must be aligned to 4 bytes (8
+ * bytes for the native format) and must remain valid and unmodified until the
+ * result is destroyed. Its fields must already be in host byte order (which is
+ * always the case for native files on little-endian hosts);
+ * NGF_PLMD_ERROR_BYTE_ORDER_MISMATCH is returned otherwise, in which case the
+ * caller may fall back to `ngf_plmd_load`.
+ */
+ngf_plmd_error ngf_plmd_load_in_place(
+    const void*                     buf,
+    size_t                          buf_size,
+    const ngf_plmd_alloc_callbacks* alloc_cb,
+    ngf_plmd**                      result);
 void                              ngf_plmd_destroy(ngf_plmd* m, const ngf_plmd_alloc_callbacks* alloc_cb);
 const ngf_plmd_layout*            ngf_plmd_get_layout(const ngf_plmd* m);
 const ngf_plmd_cis_map*           ngf_plmd_get_image_to_cis_map(const ngf_plmd* m);
@@ -218,6 +564,109 @@ const ngf_plmd_threadgroup_size*  ngf_plmd_get_threadgroup_size(const ngf_plmd*
 const ngf_plmd_entrypoints*       ngf_plmd_get_entrypoints(const ngf_plmd* m);
 const ngf_plmd_header*            ngf_plmd_get_header(const ngf_plmd* m);
 
+/**
+ * Returns the native binding map, or NULL if the file does not store one
+ * (legacy files and native files older than version 1.1).
+ */
+const ngf_plmd_native_binding_map* ngf_plmd_get_native_binding_map(const ngf_plmd* m);
+
+/**
+ * Looks up the native binding of the descriptor at the given set and binding
+ * in constant time.
+ * @return The native binding, or NGF_PLMD_NO_NATIVE_BINDING if there is no such
+ * descriptor or the file does not store a native binding map.
+ */
+uint32_t ngf_plmd_get_native_binding(const ngf_plmd* m, uint32_t set, uint32_t binding);
+
+/**
+ * Returns the descriptor counts of the pipeline, or NULL if the file does not
+ * store them (legacy files and native files older than version 1.2).
+ */
+const ngf_plmd_descriptor_pool_sizes* ngf_plmd_get_descriptor_pool_sizes(const ngf_plmd* m);
+
+/**
+ * Returns the interface variables of all pipeline stages, or NULL if the file
+ * does not store them (legacy files and native files older than version 1.3).
+ */
+const ngf_plmd_interface_vars* ngf_plmd_get_interface_vars(const ngf_plmd* m);
+
+/**
+ * Finds the inputs or outputs of the given pipeline stage. For example, the
+ * inputs of the vertex stage describe the vertex attributes of a pipeline.
+ * @param stage 0 - vertex, 1 - fragment, 2 - compute.
+ * @param direction NGF_PLMD_INTERFACE_INPUT or NGF_PLMD_INTERFACE_OUTPUT.
+ * @param nvars Receives the number of variables found.
+ * @return The first of the variables, which are sorted by location, or NULL if
+ * there are none.
+ */
+const ngf_plmd_interface_var* ngf_plmd_find_interface_vars(
+    const ngf_plmd* m,
+    uint32_t        stage,
+    uint32_t        direction,
+    uint32_t*       nvars);
+
+/**
+ * Returns the memory layouts of the blocks used by the pipeline, or NULL if the
+ * file does not store them (legacy files and native files older than version
+ * 1.4).
+ */
+const ngf_plmd_block_layouts* ngf_plmd_get_block_layouts(const ngf_plmd* m);
+
+/**
+ * Finds the memory layout of the uniform or storage buffer at the given set and
+ * binding, using a binary search.
+ * @return The block layout, or NULL if there is no such buffer or the file does
+ * not store block layouts.
+ */
+const ngf_plmd_block_layout*
+ngf_plmd_find_block_layout(const ngf_plmd* m, uint32_t set, uint32_t binding);
+
+/**
+ * Returns the memory layout of the push constant block, or NULL if the pipeline
+ * does not use push constants or the file does not store block layouts.
+ */
+const ngf_plmd_block_layout* ngf_plmd_get_push_constants_block(const ngf_plmd* m);
+
+/**
+ * Hashes a name with 32-bit FNV-1a, using the given seed to perturb the offset
+ * basis, followed by the MurmurHash3 finalizer. This is the hash function used
+ * by the descriptor index.
+ */
+uint32_t ngf_plmd_hash_name(const char* name, uint32_t seed);
+
+/**
+ * Finds the descriptor with the given name in constant time, using the perfect
+ * hash table stored in the file.
+ * @param set Receives the descriptor set of the descriptor, if not NULL.
+ * @return The descriptor, or NULL if there is no such descriptor or the file
+ * does not store a descriptor index (legacy files and native files older than
+ * version 1.5).
+ */
+const ngf_plmd_descriptor*
+ngf_plmd_find_descriptor_by_name(const ngf_plmd* m, const char* name, uint32_t* set);
+
+/**
+ * Finds the descriptor at the given set and binding. The lookup takes constant
+ * time for files that store a descriptor index, and falls back to a linear
+ * search of the set layout for older files.
+ * @return The descriptor, or NULL if there is no such descriptor.
+ */
+const ngf_plmd_descriptor*
+ngf_plmd_find_descriptor_by_binding(const ngf_plmd* m, uint32_t set, uint32_t binding);
+
+/**
+ * Returns the name that the source code uses for the descriptor at the given
+ * set and binding, or NULL if there is no such descriptor or the file does not
+ * store a descriptor index.
+ */
+const char* ngf_plmd_get_descriptor_name(const ngf_plmd* m, uint32_t set, uint32_t binding);
+
+/**
+ * Returns the header and section table of a file in the native format, or NULL
+ * if the file is in the legacy format.
+ */
+const ngf_plmd_native_header* ngf_plmd_get_native_header(const ngf_plmd* m);
+
 const char* ngf_plmd_get_error_name(const ngf_plmd_error err);
 
 #if defined(__cplusplus)
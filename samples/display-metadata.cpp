@@ -23,9 +23,11 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "metadata-parser/metadata-parser.h"
 #include "cli-tool/file-utils.h"
-#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <utility>
 #if defined(WIN32) || defined(WIN64)
 #include <io.h>
 #include <fcntl.h>
@@ -38,23 +40,72 @@ static const char *DESCRIPTOR_TYPE_NAMES[] = {
   "IMAGE",
   "SAMPLER",
   "COMBINED_IMAGE_SAMPLER",
-  "UNIFORM_TEXEL_BUFFER"
+  "ACCELERATION_STRUCTURE"
 };
 
+static const char *BASE_TYPE_NAMES[] = {
+  "UNKNOWN",
+  "VOID",
+  "BOOLEAN",
+  "SBYTE",
+  "UBYTE",
+  "SHORT",
+  "USHORT",
+  "INT",
+  "UINT",
+  "INT64",
+  "UINT64",
+  "ATOMIC_COUNTER",
+  "HALF",
+  "FLOAT",
+  "DOUBLE",
+  "STRUCT"
+};
+
+bool byte_swap_native(std::string &buf);
 void print_cis_map(const ngf_plmd_cis_map *m);
+void print_descriptor_counts(const ngf_plmd_descriptor_counts *c);
+bool check_descriptor_lookups(const ngf_plmd *m, uint32_t set, const ngf_plmd_descriptor *d);
+bool check_native_binding_lookups(const ngf_plmd *m, const ngf_plmd_native_binding_map *map);
+bool check_interface_var_lookup(const ngf_plmd *m, const ngf_plmd_interface_var *var);
+bool check_block_layout_lookup(const ngf_plmd *m, const ngf_plmd_block_layout *block);
 
 int main(int argc, const char *argv[]) {
 #if defined(WIN32) || defined(WIN64)
   _setmode(_fileno(stdout), _O_BINARY);
 #endif
   if (argc <= 1) {
-    printf("Usage: display_metadata <file name>\n");
+    printf("Usage: display_metadata <file name> [in-place|copy|swapped]\n");
+    printf("  in-place - read the file contents in place if possible (default).\n");
+    printf("  copy     - load a copy of the file contents that is not 4-byte aligned.\n");
+    printf("  swapped  - load the file contents in the opposite byte order (native files "
+           "only).\n");
     exit(0);
   }
   const char *file_name = argv[1];
+  const std::string load_mode = argc > 2 ? argv[2] : "in-place";
   std::string buf = read_file(file_name);
+  if (load_mode == "swapped" && !byte_swap_native(buf)) {
+    fprintf(stderr, "Only files in the native format can be byte-swapped\n");
+    exit(1);
+  }
   ngf_plmd *m;
-  ngf_plmd_error err = ngf_plmd_load(buf.data(), buf.size(), NULL, &m);
+  ngf_plmd_error err;
+  if (load_mode == "in-place") {
+    // Read the metadata straight from the file contents if possible, and fall back to loading a
+    // converted copy otherwise.
+    err = ngf_plmd_load_in_place(buf.data(), buf.size(), NULL, &m);
+    if (err == NGF_PLMD_ERROR_BYTE_ORDER_MISMATCH || err == NGF_PLMD_ERROR_MISALIGNED_BUFFER) {
+      err = ngf_plmd_load(buf.data(), buf.size(), NULL, &m);
+    }
+  } else if (load_mode == "copy" || load_mode == "swapped") {
+    // Offsetting the contents by a byte makes sure they cannot be read in place.
+    const std::string misaligned = std::string(1u, '\0') + buf;
+    err = ngf_plmd_load(misaligned.data() + 1u, buf.size(), NULL, &m);
+  } else {
+    fprintf(stderr, "Unknown load mode \"%s\"\n", load_mode.c_str());
+    exit(1);
+  }
   if (err != NGF_PLMD_ERROR_OK) {
     fprintf(stderr, "Error loading pipeline metadata: %d\n", err);
     exit(1);
@@ -89,7 +140,14 @@ int main(int argc, const char *argv[]) {
     printf("      \"descriptors\": [\n");
     for (uint32_t di = 0u; di < dsl->ndescriptors; ++di) {
       const ngf_plmd_descriptor *d = &(dsl->descriptors[di]);
+      if (!check_descriptor_lookups(m, s, d)) {
+        exit(1);
+      }
+      const char *name = ngf_plmd_get_descriptor_name(m, s, d->binding);
       printf("        {\n");
+      if (name != NULL) {
+        printf("          \"name\": \"%s\",\n", name);
+      }
       printf("          \"binding\": %d,\n", d->binding);
       printf("          \"type\": \"%s\",\n", DESCRIPTOR_TYPE_NAMES[d->type]);
       printf("          \"stage_vis\": %d\n", d->stage_visibility_mask);
@@ -112,6 +170,99 @@ int main(int argc, const char *argv[]) {
   print_cis_map(ngf_plmd_get_sampler_to_cis_map(m));
   printf("},\n");
 
+  // Files in the legacy format do not have a native binding map.
+  const ngf_plmd_native_binding_map *binding_map = ngf_plmd_get_native_binding_map(m);
+  if (binding_map != NULL) {
+    if (!check_native_binding_lookups(m, binding_map)) {
+      exit(1);
+    }
+    printf("\"native_binding_map\": {\n");
+    printf("  \"push_constants\": %d,\n", (int)binding_map->push_constants_native_binding);
+    printf("  \"descriptor_sets\": [\n");
+    for (uint32_t s = 0u; s < binding_map->nsets; ++s) {
+      const ngf_plmd_native_binding_set *set = binding_map->sets[s];
+      printf("    [");
+      for (uint32_t b = 0u; b < set->nbindings; ++b) {
+        printf("%d%s", (int)set->native_bindings[b], b != set->nbindings - 1u ? ", " : "");
+      }
+      printf("]%s", s != binding_map->nsets - 1u ? ",\n" : "\n");
+    }
+    printf("  ]\n");
+    printf("},\n");
+  }
+
+  const ngf_plmd_descriptor_pool_sizes *pool_sizes = ngf_plmd_get_descriptor_pool_sizes(m);
+  if (pool_sizes != NULL) {
+    printf("\"descriptor_pool_sizes\": {\n");
+    printf("  \"total\": ");
+    print_descriptor_counts(pool_sizes->total);
+    printf(",\n");
+    printf("  \"descriptor_sets\": [\n");
+    for (uint32_t s = 0u; s < pool_sizes->nsets; ++s) {
+      printf("    ");
+      print_descriptor_counts(&pool_sizes->sets[s]);
+      printf("%s", s != pool_sizes->nsets - 1u ? ",\n" : "\n");
+    }
+    printf("  ]\n");
+    printf("},\n");
+  }
+
+  const ngf_plmd_interface_vars *interface_vars = ngf_plmd_get_interface_vars(m);
+  if (interface_vars != NULL) {
+    printf("\"interface_vars\": [\n");
+    for (uint32_t v = 0u; v < interface_vars->nvars; ++v) {
+      const ngf_plmd_interface_var *var = &interface_vars->vars[v];
+      if (!check_interface_var_lookup(m, var)) {
+        exit(1);
+      }
+      printf("  {\"stage\": %d, \"direction\": \"%s\", \"name\": \"%s\", \"base_type\": \"%s\", "
+             "\"vecsize\": %d, \"location\": %d}%s\n",
+             var->stage,
+             var->direction == NGF_PLMD_INTERFACE_INPUT ? "input" : "output",
+             var->name,
+             var->base_type < NGF_PLMD_BASE_TYPE_COUNT ? BASE_TYPE_NAMES[var->base_type] : "?",
+             var->vecsize,
+             (int)var->location,
+             v != interface_vars->nvars - 1u ? "," : "");
+    }
+    printf("],\n");
+  }
+
+  const ngf_plmd_block_layouts *block_layouts = ngf_plmd_get_block_layouts(m);
+  if (block_layouts != NULL) {
+    printf("\"block_layouts\": [\n");
+    for (uint32_t b = 0u; b < block_layouts->nblocks; ++b) {
+      const ngf_plmd_block_layout *block = &block_layouts->blocks[b];
+      if (!check_block_layout_lookup(m, block)) {
+        exit(1);
+      }
+      printf("  {\n");
+      printf("    \"set\": %d,\n", (int)block->set);
+      printf("    \"binding\": %d,\n", (int)block->binding);
+      printf("    \"size\": %d,\n", block->size);
+      printf("    \"members\": [\n");
+      for (uint32_t mi = 0u; mi < block->nmembers; ++mi) {
+        const ngf_plmd_block_member *member = &block->members[mi];
+        printf("      {\"name\": \"%s\", \"offset\": %d, \"size\": %d, \"vecsize\": %d, "
+               "\"columns\": %d, \"array_size\": %d, \"array_stride\": %d, "
+               "\"matrix_stride\": %d, \"row_major\": %s}%s\n",
+               member->name,
+               member->offset,
+               member->size,
+               member->vecsize,
+               member->columns,
+               (int)member->array_size,
+               member->array_stride,
+               member->matrix_stride,
+               (member->flags & NGF_PLMD_BLOCK_MEMBER_ROW_MAJOR_BIT) ? "true" : "false",
+               mi != block->nmembers - 1u ? "," : "");
+      }
+      printf("    ]\n");
+      printf("  }%s", b != block_layouts->nblocks - 1u ? ",\n" : "\n");
+    }
+    printf("],\n");
+  }
+
   const ngf_plmd_threadgroup_size* tgsize = ngf_plmd_get_threadgroup_size(m);
   printf(
       "\"threadgroup_size\": [%d, %d, %d],\n",
@@ -131,6 +282,39 @@ int main(int argc, const char *argv[]) {
   return 0;
 }
 
+// Converts the contents of a native metadata file to the opposite byte order. Every section other
+// than the string table consists only of 32-bit fields. Returns false for files in other formats.
+bool byte_swap_native(std::string &buf) {
+  ngf_plmd_native_header header;
+  if (buf.size() < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, buf.data(), sizeof(header));
+  if (header.magic_number != 0xdeadbeef || header.version_maj != NGF_PLMD_NATIVE_VERSION_MAJ ||
+      header.header_size > buf.size()) {
+    return false;
+  }
+  auto swap_fields = [&buf](size_t offset, size_t size) {
+    for (size_t f = offset; f + 4u <= offset + size && f + 4u <= buf.size(); f += 4u) {
+      std::swap(buf[f], buf[f + 3u]);
+      std::swap(buf[f + 1u], buf[f + 2u]);
+    }
+  };
+  for (uint32_t s = 0u; s < header.nsections; ++s) {
+    ngf_plmd_section section;
+    const size_t section_offset = sizeof(header) + s * sizeof(section);
+    if (section_offset + sizeof(section) > header.header_size) {
+      return false;
+    }
+    memcpy(&section, buf.data() + section_offset, sizeof(section));
+    if (s != NGF_PLMD_SECTION_STRING_TABLE) {
+      swap_fields(section.offset, section.size);
+    }
+  }
+  swap_fields(0u, header.header_size);
+  return true;
+}
+
 void print_cis_map(const ngf_plmd_cis_map *m) {
   printf("  \"entries\": [\n");
   for (uint32_t e = 0u; e < m->nentries; ++e) {
@@ -149,3 +333,102 @@ void print_cis_map(const ngf_plmd_cis_map *m) {
   }
   printf("  ]\n");
 }
+
+void print_descriptor_counts(const ngf_plmd_descriptor_counts *c) {
+  printf("{");
+  for (uint32_t t = 0u; t < NGF_PLMD_DESC_NUM_TYPES; ++t) {
+    printf("\"%s\": %d, ", DESCRIPTOR_TYPE_NAMES[t], c->counts[t]);
+  }
+  printf("\"unbounded\": [");
+  const char *separator = "";
+  for (uint32_t t = 0u; t < NGF_PLMD_DESC_NUM_TYPES; ++t) {
+    if (c->unbounded_types & (1u << t)) {
+      printf("%s\"%s\"", separator, DESCRIPTOR_TYPE_NAMES[t]);
+      separator = ", ";
+    }
+  }
+  printf("]}");
+}
+
+// Checks that the descriptor index agrees with the pipeline layout. Also looks up a name that is
+// not in the index: the table has no empty slots in most cases, so that name lands on a slot taken
+// by another descriptor and has to be rejected by the name comparison.
+bool check_descriptor_lookups(const ngf_plmd *m, uint32_t set, const ngf_plmd_descriptor *d) {
+  if (ngf_plmd_find_descriptor_by_binding(m, set, d->binding) != d) {
+    fprintf(stderr, "Lookup of set %u binding %u returned a different descriptor\n",
+            set, d->binding);
+    return false;
+  }
+  const char *name = ngf_plmd_get_descriptor_name(m, set, d->binding);
+  if (name == NULL) {
+    return true;
+  }
+  uint32_t name_set = ~0u;
+  if (ngf_plmd_find_descriptor_by_name(m, name, &name_set) != d || name_set != set) {
+    fprintf(stderr, "Lookup of descriptor \"%s\" returned a different descriptor\n", name);
+    return false;
+  }
+  // '#' cannot appear in an HLSL identifier, so this name is never in the index.
+  const std::string unknown_name = std::string(name) + "#";
+  if (ngf_plmd_find_descriptor_by_name(m, unknown_name.c_str(), NULL) != NULL) {
+    fprintf(stderr, "Lookup of unknown descriptor \"%s\" succeeded\n", unknown_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Checks that constant-time native binding lookups agree with the binding map, and that bindings
+// past the end of a set and sets past the end of the map have no native binding.
+bool check_native_binding_lookups(const ngf_plmd *m, const ngf_plmd_native_binding_map *map) {
+  for (uint32_t s = 0u; s < map->nsets; ++s) {
+    const ngf_plmd_native_binding_set *set = map->sets[s];
+    for (uint32_t b = 0u; b <= set->nbindings; ++b) {
+      const uint32_t expected = b < set->nbindings ? set->native_bindings[b]
+                                                   : NGF_PLMD_NO_NATIVE_BINDING;
+      if (ngf_plmd_get_native_binding(m, s, b) != expected) {
+        fprintf(stderr, "Native binding lookup of set %u binding %u returned %u instead of %u\n",
+                s, b, ngf_plmd_get_native_binding(m, s, b), expected);
+        return false;
+      }
+    }
+  }
+  if (ngf_plmd_get_native_binding(m, map->nsets, 0u) != NGF_PLMD_NO_NATIVE_BINDING) {
+    fprintf(stderr, "Native binding lookup of missing set %u succeeded\n", map->nsets);
+    return false;
+  }
+  return true;
+}
+
+// Checks that looking up the variables of a stage and direction returns a range that contains the
+// given variable, and nothing from other stages or directions.
+bool check_interface_var_lookup(const ngf_plmd *m, const ngf_plmd_interface_var *var) {
+  uint32_t nstage_vars = 0u;
+  const ngf_plmd_interface_var *stage_vars =
+      ngf_plmd_find_interface_vars(m, var->stage, var->direction, &nstage_vars);
+  if (stage_vars == NULL || var < stage_vars || var >= stage_vars + nstage_vars) {
+    fprintf(stderr, "Lookup of interface variable \"%s\" did not return it\n", var->name);
+    return false;
+  }
+  for (uint32_t v = 0u; v < nstage_vars; ++v) {
+    if (stage_vars[v].stage != var->stage || stage_vars[v].direction != var->direction) {
+      fprintf(stderr, "Lookup of interface variable \"%s\" returned variables of another stage "
+                      "or direction\n", var->name);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Checks that the binary search over block layouts finds the given block.
+bool check_block_layout_lookup(const ngf_plmd *m, const ngf_plmd_block_layout *block) {
+  if (ngf_plmd_find_block_layout(m, block->set, block->binding) != block) {
+    fprintf(stderr, "Lookup of the block at set %u binding %u returned a different block\n",
+            block->set, block->binding);
+    return false;
+  }
+  if (block->set == NGF_PLMD_PUSH_CONSTANTS_SET && ngf_plmd_get_push_constants_block(m) != block) {
+    fprintf(stderr, "The push constant block was not returned as such\n");
+    return false;
+  }
+  return true;
+}
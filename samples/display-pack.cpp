@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+#include "shader-pack/shader-pack.h"
+#include "spirv-codec/spirv-codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#if defined(WIN32) || defined(WIN64)
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+static const char *STAGE_NAMES[] = {"vertex", "fragment", "compute"};
+
+// FNV-1a of a shader's code, so that changes to the contents show up in the output.
+static uint32_t code_hash(const ngf_shpk_blob &code) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0u; i < code.size; ++i) {
+    h = (h ^ ((const uint8_t*)code.data)[i]) * 16777619u;
+  }
+  return h;
+}
+
+int main(int argc, const char *argv[]) {
+#if defined(WIN32) || defined(WIN64)
+  _setmode(_fileno(stdout), _O_BINARY);
+#endif
+  if (argc <= 1) {
+    printf("Usage: display_pack <file name>\n");
+    exit(0);
+  }
+  ngf_shpk *pack;
+  ngf_shpk_error err = ngf_shpk_open_file(argv[1], NULL, &pack);
+  if (err != NGF_SHPK_ERROR_OK) {
+    fprintf(stderr, "Error opening shader pack: %s\n", ngf_shpk_get_error_name(err));
+    exit(1);
+  }
+  const ngf_shpk_header *header = ngf_shpk_get_header(pack);
+  const ngf_shpk_technique *techniques = (const ngf_shpk_technique*)(
+      (const char*)header + header->techniques_offset);
+  printf("{\n");
+  printf("\"version_maj\": %d,\n", header->version_maj);
+  printf("\"version_min\": %d,\n", header->version_min);
+  printf("\"techniques\": [\n");
+  for (uint32_t t = 0u; t < header->ntechniques; ++t) {
+    // Look each technique up by name, the way a runtime would.
+    const char *name = ngf_shpk_get_technique_name(pack, &techniques[t]);
+    const ngf_shpk_technique *tech = ngf_shpk_find_technique(pack, name);
+    if (tech != &techniques[t]) {
+      fprintf(stderr, "Technique lookup failed: %s\n", name);
+      exit(1);
+    }
+    const ngf_shpk_blob metadata = ngf_shpk_get_metadata(pack, tech);
+    ngf_plmd *m;
+    const ngf_plmd_error plmd_err =
+        ngf_plmd_load_in_place(metadata.data, metadata.size, NULL, &m);
+    if (plmd_err != NGF_PLMD_ERROR_OK) {
+      fprintf(stderr, "Error loading pipeline metadata: %d\n", plmd_err);
+      exit(1);
+    }
+    ngf_plmd_destroy(m, NULL);
+    printf("  {\n");
+    printf("    \"name\": \"%s\",\n", name);
+    printf("    \"metadata_size\": %d,\n", (int)metadata.size);
+    printf("    \"shaders\": [\n");
+    const ngf_shpk_shader *shaders = (const ngf_shpk_shader*)(
+        (const char*)header + header->shaders_offset) + tech->first_shader;
+    for (uint32_t s = 0u; s < tech->nshaders; ++s) {
+      const char *target = (const char*)header + header->string_table_offset +
+                           shaders[s].target_offset;
+      const ngf_shpk_blob code = ngf_shpk_find_shader(pack, tech, shaders[s].stage, target);
+      printf("      {\n");
+      printf("        \"stage\": \"%s\",\n", STAGE_NAMES[shaders[s].stage]);
+      printf("        \"target\": \"%s\",\n", target);
+      printf("        \"size\": %d,\n", (int)code.size);
+      printf("        \"hash\": %u", code_hash(code));
+      if (strcmp(target, "spvz") == 0) {
+        // Make sure that encoded SPIR-V decodes back to the original module.
+        size_t         decoded_size = 0u;
+        ngf_spvz_error spvz_err     = ngf_spvz_get_decoded_size(
+            (const uint8_t*)code.data,
+            code.size,
+            &decoded_size);
+        std::vector<uint32_t> decoded(decoded_size / sizeof(uint32_t));
+        if (spvz_err == NGF_SPVZ_ERROR_OK) {
+          spvz_err = ngf_spvz_decode(
+              (const uint8_t*)code.data,
+              code.size,
+              decoded.data(),
+              decoded_size);
+        }
+        if (spvz_err != NGF_SPVZ_ERROR_OK) {
+          fprintf(stderr, "Error decoding SPIR-V: %s\n", ngf_spvz_get_error_name(spvz_err));
+          exit(1);
+        }
+        const ngf_shpk_blob decoded_code = {decoded.data(), decoded_size};
+        printf(",\n        \"decoded_size\": %d,\n", (int)decoded_size);
+        printf("        \"decoded_hash\": %u", code_hash(decoded_code));
+      }
+      printf("\n");
+      printf("      }%s", s != tech->nshaders - 1u ? ",\n" : "\n");
+    }
+    printf("    ]\n");
+    printf("  }%s", t != header->ntechniques - 1u ? ",\n" : "\n");
+  }
+  printf("]\n}\n");
+  ngf_shpk_close(pack, NULL);
+  return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+// Compiles a technique whose two entry points share a header served from memory by an include
+// resolver and a header loaded from disk, and prints how the includes were served. The header on
+// disk is then changed in size and in modification time, which must make the include cache reload
+// it. The shaders are written into the given folder.
+
+#include "libniceshade/niceshade.h"
+#include <filesystem>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#if defined(WIN32) || defined(WIN64)
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+using namespace niceshade;
+
+static const char *MAIN_SOURCE =
+    "#include \"from_disk.hlsl\"\n"
+    "#include \"from_memory.hlsl\"\n"
+    "\n"
+    "float4 VSMain(uint vid : SV_VertexID) : SV_POSITION {\n"
+    "  return corner(vid) * tint().a;\n"
+    "}\n"
+    "\n"
+    "float4 PSMain() : SV_TARGET {\n"
+    "  return tint();\n"
+    "}\n"
+    "\n"
+    "//T: resolve_includes vs:VSMain ps:PSMain\n";
+
+static const char *MEMORY_HEADER =
+    "float4 corner(uint vid) {\n"
+    "  return float4(float(vid & 1u) * 4.0 - 1.0, float(vid >> 1u) * 4.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+// The second and third versions differ from the first in size, and from each other only in
+// contents, so the last change can only be noticed through the modification time.
+static const char *DISK_HEADERS[] = {
+    "float4 tint() { return float4(1.0, 0.5, 0.25, 1.0); }\n",
+    "float4 tint() { return float4(1.0, 0.5, 0.25, 1.0) * 0.5; }\n",
+    "float4 tint() { return float4(0.5, 1.0, 0.25, 1.0) * 0.5; }\n"};
+
+static bool write_text(const std::filesystem::path &path, const char *text) {
+  FILE *file = fopen(path.string().c_str(), "wb");
+  if (file == NULL) {
+    fprintf(stderr, "Failed to open %s for writing\n", path.string().c_str());
+    return false;
+  }
+  const size_t size = strlen(text);
+  const bool ok = fwrite(text, 1u, size, file) == size;
+  return fclose(file) == 0 && ok;
+}
+
+static bool compile_and_report(instance &inst, const std::filesystem::path &main_path,
+                               include_stats &previous, const char *step) {
+  printf("%s\n", step);
+  const target_desc target {target_api::VULKAN, 1u, 0u, target_platform_class::DONTCARE};
+  auto result = inst.parse_techniques_and_compile_file(
+      main_path.string().c_str(), const_span<target_desc> {&target, 1u}, define_container {});
+  if (result.is_error()) {
+    fprintf(stderr, "%s", result.error_message().c_str());
+    return false;
+  }
+  const include_stats stats = inst.include_statistics();
+  printf("  resolved %u, loaded %u, cache hits %u\n",
+         stats.resolved - previous.resolved,
+         stats.loaded - previous.loaded,
+         stats.cache_hits - previous.cache_hits);
+  previous = stats;
+  return true;
+}
+
+int main(int argc, const char *argv[]) {
+#if defined(WIN32) || defined(WIN64)
+  _setmode(_fileno(stdout), _O_BINARY);
+#endif
+  if (argc <= 1) {
+    printf("Usage: resolve_includes <folder>\n");
+    exit(0);
+  }
+  const std::filesystem::path folder = argv[1];
+  const std::filesystem::path main_path = folder / "resolve_includes.hlsl";
+  const std::filesystem::path disk_header_path = folder / "from_disk.hlsl";
+  std::error_code ec;
+  std::filesystem::create_directories(folder, ec);
+  if (!write_text(main_path, MAIN_SOURCE) || !write_text(disk_header_path, DISK_HEADERS[0])) {
+    exit(1);
+  }
+
+  // Only from_memory.hlsl is served by the resolver. Every request it sees is printed, whether it
+  // serves the file or not.
+  instance::options opts;
+  const std::string exe_path(argv[0]);
+  opts.dxc_lib_folder = exe_path.substr(0, exe_path.find_last_of("/\\")) + "/..";
+  opts.include_resolver = [](const char *path, input_blob &contents) {
+    const char *file_name = path + strlen(path);
+    while (file_name > path && file_name[-1] != '/' && file_name[-1] != '\\') --file_name;
+    const bool from_memory = strcmp(file_name, "from_memory.hlsl") == 0;
+    printf("  resolver asked for %s\n", file_name);
+    if (from_memory) {
+      contents = input_blob {(const std::byte *)MEMORY_HEADER, strlen(MEMORY_HEADER)};
+    }
+    return from_memory;
+  };
+  value_or_error<instance> maybe_inst = instance::create(opts);
+  if (maybe_inst.is_error()) {
+    fprintf(stderr, "%s", maybe_inst.error_message().c_str());
+    exit(1);
+  }
+  instance &inst = maybe_inst.get();
+
+  include_stats previous;
+  if (!compile_and_report(inst, main_path, previous, "first compile")) exit(1);
+  if (!compile_and_report(inst, main_path, previous, "unchanged")) exit(1);
+
+  if (!write_text(disk_header_path, DISK_HEADERS[1])) exit(1);
+  if (!compile_and_report(inst, main_path, previous, "size changed")) exit(1);
+
+  // Move the modification time well past the previous one, so that the change is noticed even on
+  // file systems with coarse timestamps.
+  const auto previous_time = std::filesystem::last_write_time(disk_header_path, ec);
+  if (!write_text(disk_header_path, DISK_HEADERS[2])) exit(1);
+  std::filesystem::last_write_time(disk_header_path, previous_time + std::chrono::seconds(10), ec);
+  if (ec) {
+    fprintf(stderr, "Failed to set the modification time: %s\n", ec.message().c_str());
+    exit(1);
+  }
+  if (!compile_and_report(inst, main_path, previous, "modification time changed")) exit(1);
+  return 0;
+}
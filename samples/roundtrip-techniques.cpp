@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "libniceshade/niceshade.h"
+#include "libniceshade/serialization.h"
+#include "cli-tool/target-list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#if defined(WIN32) || defined(WIN64)
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+using namespace niceshade;
+
+static const char *STAGE_NAMES[] = {"vertex", "fragment", "compute"};
+
+// Serializes the given techniques again and checks that the result matches the original data.
+static bool reserializes_to(const compiled_techniques &techs, const std::vector<std::byte> &data) {
+  const std::vector<std::byte> again = serialize_techniques(techs);
+  return again.size() == data.size() && memcmp(again.data(), data.data(), data.size()) == 0;
+}
+
+// Compiles the given file and round-trips the results through serialize_techniques. The data is
+// loaded both from a copy and in place, and both sets of techniques must serialize to exactly the
+// same data again. The serialized data and the techniques loaded in place are returned.
+static bool compile_and_load(const char *exe_path, const char *file_path,
+                             const std::vector<target_desc> &targets,
+                             std::vector<std::byte> &original, compiled_techniques &loaded) {
+  // The DXC library is looked up next to the niceshade binary, one folder up.
+  const std::string exe_path_str(exe_path);
+  instance::options opts;
+  opts.dxc_lib_folder = exe_path_str.substr(0, exe_path_str.find_last_of("/\\")) + "/..";
+  value_or_error<instance> maybe_inst = instance::create(opts);
+  if (maybe_inst.is_error()) {
+    fprintf(stderr, "%s", maybe_inst.error_message().c_str());
+    return false;
+  }
+  auto maybe_results = maybe_inst.get().parse_techniques_and_compile_file(
+      file_path,
+      const_span<target_desc> {targets.data(), targets.size()},
+      define_container {});
+  if (maybe_results.is_error()) {
+    fprintf(stderr, "%s", maybe_results.error_message().c_str());
+    return false;
+  }
+  auto data = std::make_shared<std::vector<std::byte>>(
+      serialize_techniques(std::get<compiled_techniques>(maybe_results.get())));
+  const const_span<std::byte> span {data->data(), data->size()};
+  value_or_error<compiled_techniques> copied = deserialize_techniques(span);
+  value_or_error<compiled_techniques> in_place = deserialize_techniques(span, data);
+  if (copied.is_error() || in_place.is_error()) {
+    fprintf(stderr, "%s", (copied.is_error() ? copied : in_place).error_message().c_str());
+    return false;
+  }
+  if (!reserializes_to(copied.get(), *data) || !reserializes_to(in_place.get(), *data)) {
+    fprintf(stderr, "Serializing the loaded techniques again produced different data\n");
+    return false;
+  }
+  original = *data;
+  loaded   = std::move(in_place.get());
+  return true;
+}
+
+int main(int argc, const char *argv[]) {
+#if defined(WIN32) || defined(WIN64)
+  _setmode(_fileno(stdout), _O_BINARY);
+#endif
+  if (argc <= 1) {
+    printf("Usage: roundtrip_techniques <file name> [target...]\n");
+    exit(0);
+  }
+  std::vector<target_desc> targets;
+  for (int a = 2; a < argc; ++a) {
+    const named_target_info *info = NULL;
+    for (const named_target_info &t : TARGET_MAP) {
+      if (strcmp(t.name, argv[a]) == 0) info = &t;
+    }
+    if (info == NULL) {
+      fprintf(stderr, "Unknown target %s\n", argv[a]);
+      exit(1);
+    }
+    targets.push_back(info->target);
+  }
+
+  // Everything but the techniques loaded in place is released by the time this returns, so their
+  // names and code must have remained valid.
+  std::vector<std::byte> original;
+  compiled_techniques    techs;
+  if (!compile_and_load(argv[0], argv[1], targets, original, techs)) {
+    exit(1);
+  }
+  if (!reserializes_to(techs, original)) {
+    fprintf(stderr, "Techniques loaded in place did not outlive the caller's data\n");
+    exit(1);
+  }
+
+  printf("{\n");
+  printf("\"version\": %u,\n", serialized_techniques_version);
+  printf("\"techniques\": [\n");
+  for (size_t t = 0u; t < techs.size(); ++t) {
+    const compiled_technique &tech = techs[t];
+    printf("  {\n");
+    printf("    \"name\": \"%s\",\n", tech.name.c_str());
+    printf("    \"descriptors\": [");
+    const char *separator = "";
+    for (const descriptor_set_layout &set : tech.layout) {
+      for (const descriptor &d : set) {
+        printf("%s\"%.*s\"", separator, (int)d.name.size(), d.name.data());
+        separator = ", ";
+      }
+    }
+    printf("],\n");
+    printf("    \"spec_consts\": [");
+    separator = "";
+    for (const auto &sc : tech.spec_consts) {
+      printf("%s\"%.*s\"", separator, (int)sc.first.size(), sc.first.data());
+      separator = ", ";
+    }
+    printf("],\n");
+    printf("    \"interface_vars\": [");
+    separator = "";
+    for (const interface_variables &iface : tech.per_stage_interface) {
+      for (const arena_vector<interface_variable> *vars : {&iface.input_vars, &iface.output_vars}) {
+        for (const interface_variable &v : *vars) {
+          printf("%s\"%s:%.*s\"", separator, STAGE_NAMES[(int)iface.stage],
+                 (int)v.name.size(), v.name.data());
+          separator = ", ";
+        }
+      }
+    }
+    printf("],\n");
+    printf("    \"outputs\": %zu\n", tech.targeted_outputs.size());
+    printf("  }%s\n", t + 1u < techs.size() ? "," : "");
+  }
+  printf("]\n}\n");
+  return 0;
+}
@@ -0,0 +1,358 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "shader-pack.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32) || defined(_WIN64)
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+// The pack itself is the only allocation made here, so fall back to stdlib
+// malloc/free directly instead of keeping a default set of callbacks.
+static void* _pack_alloc(const ngf_plmd_alloc_callbacks *alloc_cb, size_t size) {
+  return alloc_cb != NULL ? alloc_cb->alloc(size) : malloc(size);
+}
+
+static void _pack_free(const ngf_plmd_alloc_callbacks *alloc_cb, void *ptr) {
+  if (alloc_cb != NULL) {
+    alloc_cb->free(ptr);
+  } else {
+    free(ptr);
+  }
+}
+
+struct ngf_shpk {
+  const uint8_t *data;
+  size_t size;
+  const ngf_shpk_header *header;
+  const ngf_shpk_technique *techniques;
+  const ngf_shpk_shader *shaders;
+  const char *strings;
+  bool mapped;
+#if defined(_WIN32) || defined(_WIN64)
+  HANDLE mapping;
+#endif
+};
+
+static bool _range_in_bounds(uint32_t offset, uint32_t size, size_t buf_size) {
+  return size <= buf_size && offset <= buf_size - size;
+}
+
+static bool _table_in_bounds(uint32_t offset, uint32_t count,
+                             size_t entry_size, size_t buf_size) {
+  return (offset & 0b11) == 0 && offset <= buf_size &&
+         count <= (buf_size - offset) / entry_size;
+}
+
+static bool _blob_in_bounds(uint32_t offset, uint32_t size, size_t buf_size) {
+  return (offset & 0b111) == 0 && _range_in_bounds(offset, size, buf_size);
+}
+
+// Validates the header and all of the tables in a single pass, so that lookups
+// need no further bounds checks.
+static ngf_shpk_error _validate(ngf_shpk *pack) {
+  const size_t size = pack->size;
+  if (size < sizeof(ngf_shpk_header)) {
+    return NGF_SHPK_ERROR_MALFORMED_PACK;
+  }
+  const ngf_shpk_header *header = (const ngf_shpk_header*)pack->data;
+  if (header->magic_number != NGF_SHPK_MAGIC_NUMBER) {
+    const uint8_t *m = pack->data;
+    const uint32_t swapped = (uint32_t)m[3] | (uint32_t)m[2] << 8u |
+                             (uint32_t)m[1] << 16u | (uint32_t)m[0] << 24u;
+    return swapped == NGF_SHPK_MAGIC_NUMBER ? NGF_SHPK_ERROR_BYTE_ORDER_MISMATCH
+                                            : NGF_SHPK_ERROR_MAGIC_NUMBER_MISMATCH;
+  }
+  if (header->version_maj != NGF_SHPK_VERSION_MAJ) {
+    return NGF_SHPK_ERROR_UNSUPPORTED_VERSION;
+  }
+  if (header->header_size < sizeof(ngf_shpk_header) || header->header_size > size ||
+      !_table_in_bounds(header->techniques_offset, header->ntechniques,
+                        sizeof(ngf_shpk_technique), size) ||
+      !_table_in_bounds(header->shaders_offset, header->nshaders,
+                        sizeof(ngf_shpk_shader), size) ||
+      !_range_in_bounds(header->string_table_offset, header->string_table_size, size)) {
+    return NGF_SHPK_ERROR_MALFORMED_PACK;
+  }
+
+  // Technique and target names are compared and returned straight from the
+  // string table, so it has to end with a null character for any offset inside
+  // it to be safe to read.
+  const char *strings = (const char*)pack->data + header->string_table_offset;
+  const uint32_t strings_size = header->string_table_size;
+  if (strings_size > 0u && strings[strings_size - 1u] != '\0') {
+    return NGF_SHPK_ERROR_MALFORMED_PACK;
+  }
+
+  const ngf_shpk_technique *techniques =
+      (const ngf_shpk_technique*)(pack->data + header->techniques_offset);
+  for (uint32_t t = 0u; t < header->ntechniques; ++t) {
+    const ngf_shpk_technique *tech = &techniques[t];
+    if ((t > 0u && tech->name_hash < techniques[t - 1u].name_hash) ||
+        tech->name_offset >= strings_size ||
+        !_blob_in_bounds(tech->metadata_offset, tech->metadata_size, size) ||
+        tech->first_shader > header->nshaders ||
+        tech->nshaders > header->nshaders - tech->first_shader) {
+      return NGF_SHPK_ERROR_MALFORMED_PACK;
+    }
+  }
+
+  const ngf_shpk_shader *shaders =
+      (const ngf_shpk_shader*)(pack->data + header->shaders_offset);
+  for (uint32_t s = 0u; s < header->nshaders; ++s) {
+    const ngf_shpk_shader *shader = &shaders[s];
+    if (shader->target_offset >= strings_size ||
+        !_blob_in_bounds(shader->offset, shader->size, size)) {
+      return NGF_SHPK_ERROR_MALFORMED_PACK;
+    }
+  }
+
+  pack->header = header;
+  pack->techniques = techniques;
+  pack->shaders = shaders;
+  pack->strings = strings;
+  return NGF_SHPK_ERROR_OK;
+}
+
+ngf_shpk_error ngf_shpk_open_memory(const void *buf, size_t buf_size,
+                                    const ngf_plmd_alloc_callbacks *alloc_cb,
+                                    ngf_shpk **result) {
+  ngf_shpk_error err = NGF_SHPK_ERROR_OK;
+  ngf_shpk *pack = NULL;
+  assert(buf);
+  assert(result);
+
+  // Blobs within the pack are 8-byte aligned, so that pipeline metadata can be
+  // read in place.
+  if (((uintptr_t)buf & 0b111) != 0) {
+    err = NGF_SHPK_ERROR_MISALIGNED_BUFFER;
+    goto ngf_shpk_open_memory_cleanup;
+  }
+
+  pack = _pack_alloc(alloc_cb, sizeof(ngf_shpk));
+  if (pack == NULL) {
+    err = NGF_SHPK_ERROR_OUTOFMEM;
+    goto ngf_shpk_open_memory_cleanup;
+  }
+  memset(pack, 0u, sizeof(ngf_shpk));
+  pack->data = buf;
+  pack->size = buf_size;
+  err = _validate(pack);
+
+ngf_shpk_open_memory_cleanup:
+  if (err != NGF_SHPK_ERROR_OK) {
+    ngf_shpk_close(pack, alloc_cb);
+    pack = NULL;
+  }
+  *result = pack;
+  return err;
+}
+
+ngf_shpk_error ngf_shpk_open_file(const char *path,
+                                  const ngf_plmd_alloc_callbacks *alloc_cb,
+                                  ngf_shpk **result) {
+  ngf_shpk_error err = NGF_SHPK_ERROR_OK;
+  ngf_shpk *pack = NULL;
+  assert(path);
+  assert(result);
+
+  pack = _pack_alloc(alloc_cb, sizeof(ngf_shpk));
+  if (pack == NULL) {
+    err = NGF_SHPK_ERROR_OUTOFMEM;
+    goto ngf_shpk_open_file_cleanup;
+  }
+  memset(pack, 0u, sizeof(ngf_shpk));
+
+#if defined(_WIN32) || defined(_WIN64)
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    err = NGF_SHPK_ERROR_FILE_ACCESS;
+    goto ngf_shpk_open_file_cleanup;
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    CloseHandle(file);
+    err = NGF_SHPK_ERROR_FILE_ACCESS;
+    goto ngf_shpk_open_file_cleanup;
+  }
+  // Empty files can not be mapped.
+  if (file_size.QuadPart == 0) {
+    CloseHandle(file);
+    err = NGF_SHPK_ERROR_MALFORMED_PACK;
+    goto ngf_shpk_open_file_cleanup;
+  }
+  // The mapping keeps the file open, so the file handle is no longer needed.
+  pack->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (pack->mapping == NULL) {
+    err = NGF_SHPK_ERROR_FILE_ACCESS;
+    goto ngf_shpk_open_file_cleanup;
+  }
+  pack->data = MapViewOfFile(pack->mapping, FILE_MAP_READ, 0, 0, 0);
+  pack->size = (size_t)file_size.QuadPart;
+#else
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    err = NGF_SHPK_ERROR_FILE_ACCESS;
+    goto ngf_shpk_open_file_cleanup;
+  }
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) != 0) {
+    close(fd);
+    err = NGF_SHPK_ERROR_FILE_ACCESS;
+    goto ngf_shpk_open_file_cleanup;
+  }
+  // Empty files can not be mapped.
+  if (statbuf.st_size == 0) {
+    close(fd);
+    err = NGF_SHPK_ERROR_MALFORMED_PACK;
+    goto ngf_shpk_open_file_cleanup;
+  }
+  // The mapping keeps the file open, so the descriptor is no longer needed.
+  void *data = mmap(NULL, (size_t)statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  pack->data = data == MAP_FAILED ? NULL : data;
+  pack->size = (size_t)statbuf.st_size;
+#endif
+  if (pack->data == NULL) {
+    err = NGF_SHPK_ERROR_FILE_ACCESS;
+    goto ngf_shpk_open_file_cleanup;
+  }
+  pack->mapped = true;
+  err = _validate(pack);
+
+ngf_shpk_open_file_cleanup:
+  if (err != NGF_SHPK_ERROR_OK) {
+    ngf_shpk_close(pack, alloc_cb);
+    pack = NULL;
+  }
+  *result = pack;
+  return err;
+}
+
+void ngf_shpk_close(ngf_shpk *pack, const ngf_plmd_alloc_callbacks *alloc_cb) {
+  if (pack != NULL) {
+#if defined(_WIN32) || defined(_WIN64)
+    if (pack->data != NULL && pack->mapped) {
+      UnmapViewOfFile(pack->data);
+    }
+    if (pack->mapping != NULL) {
+      CloseHandle(pack->mapping);
+    }
+#else
+    if (pack->data != NULL && pack->mapped) {
+      munmap((void*)pack->data, pack->size);
+    }
+#endif
+    _pack_free(alloc_cb, pack);
+  }
+}
+
+uint32_t ngf_shpk_hash_name(const char *name) {
+  uint32_t hash = 2166136261u;
+  for (const uint8_t *c = (const uint8_t*)name; *c != '\0'; ++c) {
+    hash = (hash ^ *c) * 16777619u;
+  }
+  return hash;
+}
+
+const ngf_shpk_technique* ngf_shpk_find_technique(const ngf_shpk *pack,
+                                                  const char *name) {
+  const uint32_t hash = ngf_shpk_hash_name(name);
+  const ngf_shpk_technique *techniques = pack->techniques;
+  const uint32_t ntechniques = pack->header->ntechniques;
+
+  // Find the first entry with a matching hash, then compare names to resolve
+  // collisions.
+  uint32_t lo = 0u, hi = ntechniques;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2u;
+    if (techniques[mid].name_hash < hash) {
+      lo = mid + 1u;
+    } else {
+      hi = mid;
+    }
+  }
+  for (; lo < ntechniques && techniques[lo].name_hash == hash; ++lo) {
+    if (strcmp(pack->strings + techniques[lo].name_offset, name) == 0) {
+      return &techniques[lo];
+    }
+  }
+  return NULL;
+}
+
+const char* ngf_shpk_get_technique_name(const ngf_shpk *pack,
+                                        const ngf_shpk_technique *tech) {
+  return pack->strings + tech->name_offset;
+}
+
+ngf_shpk_blob ngf_shpk_get_metadata(const ngf_shpk *pack,
+                                    const ngf_shpk_technique *tech) {
+  ngf_shpk_blob blob = { pack->data + tech->metadata_offset, tech->metadata_size };
+  return blob;
+}
+
+ngf_shpk_blob ngf_shpk_find_shader(const ngf_shpk *pack,
+                                   const ngf_shpk_technique *tech,
+                                   uint32_t stage,
+                                   const char *target) {
+  ngf_shpk_blob blob = { NULL, 0u };
+  const ngf_shpk_shader *shaders = pack->shaders + tech->first_shader;
+  for (uint32_t s = 0u; s < tech->nshaders; ++s) {
+    if (shaders[s].stage == stage &&
+        strcmp(pack->strings + shaders[s].target_offset, target) == 0) {
+      blob.data = pack->data + shaders[s].offset;
+      blob.size = shaders[s].size;
+      break;
+    }
+  }
+  return blob;
+}
+
+const ngf_shpk_header* ngf_shpk_get_header(const ngf_shpk *pack) {
+  return pack->header;
+}
+
+const char* ngf_shpk_get_error_name(const ngf_shpk_error err) {
+  static const char* ngf_shpk_error_names[] = {
+    "OK",
+    "OUTOFMEM",
+    "FILE_ACCESS",
+    "MAGIC_NUMBER_MISMATCH",
+    "BYTE_ORDER_MISMATCH",
+    "UNSUPPORTED_VERSION",
+    "MISALIGNED_BUFFER",
+    "MALFORMED_PACK"
+  };
+  return ngf_shpk_error_names[err];
+}
@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "metadata-parser/metadata-parser.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * A shader pack stores the pipeline metadata and all shaders generated for a
+ * set of techniques in a single file, along with an index sorted by technique
+ * name hash. Packs are little-endian and are read in place, straight from a
+ * memory-mapped file or a caller-owned buffer.
+ */
+typedef struct ngf_shpk ngf_shpk;
+
+#define NGF_SHPK_MAGIC_NUMBER (0x4b504853u) /**< "SHPK" */
+#define NGF_SHPK_VERSION_MAJ  (1u)
+
+/**
+ * Shader pack header, stored at the beginning of the file. All offsets are in
+ * bytes, from the beginning of the file.
+ */
+typedef struct ngf_shpk_header {
+  uint32_t magic_number;        /**< must always be NGF_SHPK_MAGIC_NUMBER. */
+  uint32_t header_size;         /**< size of the header in bytes. */
+  uint32_t version_maj;         /**< major version of the format in use. */
+  uint32_t version_min;         /**< minor version of the format in use. */
+  uint32_t ntechniques;         /**< number of techniques in the pack. */
+  uint32_t techniques_offset;   /**< offset of the technique index. */
+  uint32_t nshaders;            /**< total number of shaders in the pack. */
+  uint32_t shaders_offset;      /**< offset of the shader table. */
+  uint32_t string_table_offset; /**< offset of the string table. */
+  uint32_t string_table_size;   /**< size of the string table in bytes. */
+} ngf_shpk_header;
+
+/**
+ * An entry of the technique index. Entries are sorted by name hash.
+ */
+typedef struct ngf_shpk_technique {
+  uint32_t name_hash;       /**< ngf_shpk_hash_name of the technique name. */
+  uint32_t name_offset;     /**< offset of the name within the string table. */
+  uint32_t metadata_offset; /**< offset of the pipeline metadata, a multiple of 8. */
+  uint32_t metadata_size;   /**< size of the pipeline metadata in bytes. */
+  uint32_t first_shader;    /**< index of the technique's first shader in the shader table. */
+  uint32_t nshaders;        /**< number of shaders the technique has. */
+} ngf_shpk_technique;
+
+/**
+ * An entry of the shader table.
+ */
+typedef struct ngf_shpk_shader {
+  uint32_t stage;         /**< 0 - vertex, 1 - fragment, 2 - compute. */
+  uint32_t target_offset; /**< offset of the target name (e.g. "spv" or "430.glsl") within the
+                               string table. */
+  uint32_t offset;        /**< offset of the shader code, a multiple of 8. */
+  uint32_t size;          /**< size of the shader code in bytes. */
+} ngf_shpk_shader;
+
+/**
+ * A range of bytes within a shader pack.
+ */
+typedef struct ngf_shpk_blob {
+  const void* data;
+  size_t      size;
+} ngf_shpk_blob;
+
+typedef enum ngf_shpk_error {
+  NGF_SHPK_ERROR_OK,
+  NGF_SHPK_ERROR_OUTOFMEM,
+  NGF_SHPK_ERROR_FILE_ACCESS,
+  NGF_SHPK_ERROR_MAGIC_NUMBER_MISMATCH,
+  NGF_SHPK_ERROR_BYTE_ORDER_MISMATCH,
+  NGF_SHPK_ERROR_UNSUPPORTED_VERSION,
+  NGF_SHPK_ERROR_MISALIGNED_BUFFER,
+  NGF_SHPK_ERROR_MALFORMED_PACK
+} ngf_shpk_error;
+
+/**
+ * Memory-maps the shader pack at the given path and validates its index. Only
+ * the small ngf_shpk object is allocated; shaders and metadata are never copied.
+ */
+ngf_shpk_error ngf_shpk_open_file(
+    const char*                     path,
+    const ngf_plmd_alloc_callbacks* alloc_cb,
+    ngf_shpk**                      result);
+
+/**
+ * Opens a shader pack stored in the given buffer, which must be aligned to 8
+ * bytes and must remain valid until the pack is closed.
+ */
+ngf_shpk_error ngf_shpk_open_memory(
+    const void*                     buf,
+    size_t                          buf_size,
+    const ngf_plmd_alloc_callbacks* alloc_cb,
+    ngf_shpk**                      result);
+
+void ngf_shpk_close(ngf_shpk* pack, const ngf_plmd_alloc_callbacks* alloc_cb);
+
+/**
+ * Finds a technique by name with a binary search over the index.
+ * @return The technique, or NULL if the pack does not contain it.
+ */
+const ngf_shpk_technique* ngf_shpk_find_technique(const ngf_shpk* pack, const char* name);
+
+/**
+ * @return The name of the given technique.
+ */
+const char* ngf_shpk_get_technique_name(const ngf_shpk* pack, const ngf_shpk_technique* tech);
+
+/**
+ * @return The pipeline metadata of the given technique. Metadata in the native
+ * format can be passed to `ngf_plmd_load_in_place` directly.
+ */
+ngf_shpk_blob ngf_shpk_get_metadata(const ngf_shpk* pack, const ngf_shpk_technique* tech);
+
+/**
+ * Finds the code of a technique's shader for the given stage and target.
+ * @return The shader code, or an empty blob if the technique has no such shader.
+ */
+ngf_shpk_blob ngf_shpk_find_shader(
+    const ngf_shpk*           pack,
+    const ngf_shpk_technique* tech,
+    uint32_t                  stage,
+    const char*               target);
+
+/**
+ * @return The header of the pack, from which the technique index and the shader
+ * table can be located for iteration.
+ */
+const ngf_shpk_header* ngf_shpk_get_header(const ngf_shpk* pack);
+
+/**
+ * Hashes a technique name the way the technique index is keyed (32-bit FNV-1a).
+ */
+uint32_t ngf_shpk_hash_name(const char* name);
+
+const char* ngf_shpk_get_error_name(const ngf_shpk_error err);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,380 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "spirv-codec.h"
+
+#include <assert.h>
+#include <stdbool.h>
+
+#define SPIRV_MAGIC_NUMBER (0x07230203u)
+#define SPIRV_HEADER_WORDS (5u)
+
+// How an instruction is encoded, as returned by _opcode_info.
+#define HAS_TYPE   (0x1u) // the first operand is a result type ID, stored as a varint.
+#define HAS_RESULT (0x2u) // the next operand is a result ID, stored relative to the previous one.
+#define RAW        (0x4u) // remaining operands are strings or literals, stored as-is.
+#define REL(n)     (((uint32_t)(n) << 8u)) // the next n operands are IDs, stored relative to the
+                                           // current result ID. Remaining ones are varints.
+#define ALL        (0xffu)
+
+static uint32_t _opcode_info(uint32_t op) {
+  switch (op) {
+  // Debug information, strings and arbitrary literals.
+  case 2:   /* OpSourceContinued */
+  case 3:   /* OpSource */
+  case 4:   /* OpSourceExtension */
+  case 5:   /* OpName */
+  case 6:   /* OpMemberName */
+  case 10:  /* OpExtension */
+  case 15:  /* OpEntryPoint */
+  case 330: /* OpModuleProcessed */
+  case 5632: /* OpDecorateString */
+  case 5633: /* OpMemberDecorateString */
+    return RAW;
+  case 7:  /* OpString */
+  case 11: /* OpExtInstImport */
+  case 31: /* OpTypeOpaque */
+    return HAS_RESULT | RAW;
+  case 43: /* OpConstant */
+  case 50: /* OpSpecConstant */
+    return HAS_TYPE | HAS_RESULT | RAW;
+
+  // Types.
+  case 19: case 20: case 21: case 22: case 23: case 24: case 25: case 26:
+  case 27: case 28: case 29: case 30: case 32: case 33:
+  case 73:  /* OpDecorationGroup */
+  case 248: /* OpLabel */
+    return HAS_RESULT;
+
+  // Constants, functions and variables.
+  case 1:  /* OpUndef */
+  case 12: /* OpExtInst */
+  case 41: case 42: case 45: case 46: case 48: case 49: case 52:
+  case 54: /* OpFunction */
+  case 55: /* OpFunctionParameter */
+  case 59: /* OpVariable */
+    return HAS_TYPE | HAS_RESULT;
+  case 44: /* OpConstantComposite */
+  case 51: /* OpSpecConstantComposite */
+  case 57: /* OpFunctionCall */
+    return HAS_TYPE | HAS_RESULT | REL(ALL);
+
+  // Memory and composite instructions.
+  case 61: /* OpLoad */
+  case 81: /* OpCompositeExtract */
+    return HAS_TYPE | HAS_RESULT | REL(1);
+  case 62: /* OpStore */
+  case 63: /* OpCopyMemory */
+  case 246: /* OpLoopMerge */
+  case 251: /* OpSwitch */
+    return REL(2);
+  case 79: /* OpVectorShuffle */
+  case 82: /* OpCompositeInsert */
+    return HAS_TYPE | HAS_RESULT | REL(2);
+  case 60: case 65: case 66: case 67: case 68:
+  case 77: case 78: case 80: case 83: case 84: case 86:
+    return HAS_TYPE | HAS_RESULT | REL(ALL);
+
+  // Image instructions. Image operands following the coordinates are varints.
+  case 87: case 88: case 91: case 92: case 95: case 98:
+    return HAS_TYPE | HAS_RESULT | REL(2);
+  case 89: case 90: case 93: case 94: case 96: case 97:
+    return HAS_TYPE | HAS_RESULT | REL(3);
+  case 99: /* OpImageWrite */
+  case 250: /* OpBranchConditional */
+    return REL(3);
+  case 100: case 101: case 102: case 103: case 104: case 105: case 106: case 107:
+    return HAS_TYPE | HAS_RESULT | REL(ALL);
+
+  // Control flow.
+  case 247: /* OpSelectionMerge */
+    return REL(1);
+  case 249: /* OpBranch */
+  case 254: /* OpReturnValue */
+    return REL(ALL);
+  case 245: /* OpPhi */
+    return HAS_TYPE | HAS_RESULT | REL(ALL);
+
+  default:
+    break;
+  }
+
+  // Conversion, arithmetic, relational, bit and derivative instructions only take IDs.
+  if ((op >= 109u && op <= 124u) || (op >= 126u && op <= 152u) || (op >= 154u && op <= 191u) ||
+      (op >= 194u && op <= 205u) || (op >= 207u && op <= 215u)) {
+    return HAS_TYPE | HAS_RESULT | REL(ALL);
+  }
+  // Anything else is stored as varints, which is lossless for any instruction.
+  return 0u;
+}
+
+// The most frequent opcodes trade places with rare ones below 8, so that their instructions start
+// with a single byte. The mapping is its own inverse.
+static uint32_t _swap_opcode(uint32_t op) {
+  static const uint32_t frequent_opcodes[8] = {
+    43, /* OpConstant */
+    32, /* OpTypePointer */
+    71, /* OpDecorate */
+    59, /* OpVariable */
+    44, /* OpConstantComposite */
+    5,  /* OpName - already below 8 */
+    61, /* OpLoad */
+    62  /* OpStore */
+  };
+  if (op < 8u) {
+    return frequent_opcodes[op];
+  }
+  for (uint32_t i = 0u; i < 8u; ++i) {
+    if (frequent_opcodes[i] == op) { return i; }
+  }
+  return op;
+}
+
+static uint32_t _zigzag(uint32_t v) {
+  return (v << 1u) ^ (0u - (v >> 31u));
+}
+
+static uint32_t _unzigzag(uint32_t v) {
+  return (v >> 1u) ^ (0u - (v & 1u));
+}
+
+typedef struct _spvz_writer {
+  uint8_t *ptr;
+  uint8_t *end;
+} _spvz_writer;
+
+static bool _write_varint(_spvz_writer *w, uint32_t v) {
+  while (v >= 0x80u) {
+    if (w->ptr == w->end) { return false; }
+    *(w->ptr++) = (uint8_t)(v | 0x80u);
+    v >>= 7u;
+  }
+  if (w->ptr == w->end) { return false; }
+  *(w->ptr++) = (uint8_t)v;
+  return true;
+}
+
+static bool _write_raw(_spvz_writer *w, uint32_t v) {
+  if (w->end - w->ptr < 4) { return false; }
+  w->ptr[0] = (uint8_t)v;
+  w->ptr[1] = (uint8_t)(v >> 8u);
+  w->ptr[2] = (uint8_t)(v >> 16u);
+  w->ptr[3] = (uint8_t)(v >> 24u);
+  w->ptr += 4;
+  return true;
+}
+
+typedef struct _spvz_reader {
+  const uint8_t *ptr;
+  const uint8_t *end;
+} _spvz_reader;
+
+static bool _read_varint(_spvz_reader *r, uint32_t *v) {
+  uint32_t result = 0u;
+  for (uint32_t shift = 0u; shift < 35u; shift += 7u) {
+    if (r->ptr == r->end) { return false; }
+    const uint32_t byte = *(r->ptr++);
+    result |= (byte & 0x7fu) << shift;
+    if (byte < 0x80u) {
+      *v = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool _read_raw(_spvz_reader *r, uint32_t *v) {
+  if (r->end - r->ptr < 4) { return false; }
+  *v = (uint32_t)r->ptr[0] | (uint32_t)r->ptr[1] << 8u |
+       (uint32_t)r->ptr[2] << 16u | (uint32_t)r->ptr[3] << 24u;
+  r->ptr += 4;
+  return true;
+}
+
+size_t ngf_spvz_encode_bound(size_t spirv_size) {
+  // The magic number and the four header varints take at most 24 bytes. An instruction of N words
+  // takes at most 6 bytes for its opcode and length, and 5 for each of the remaining words.
+  return 24u + spirv_size / sizeof(uint32_t) * 6u;
+}
+
+ngf_spvz_error ngf_spvz_encode(const uint32_t *spirv, size_t spirv_size,
+                               uint8_t *out, size_t *out_size) {
+  assert(spirv);
+  assert(out);
+  assert(out_size);
+  const size_t nwords = spirv_size / sizeof(uint32_t);
+  if (spirv_size % sizeof(uint32_t) != 0u || nwords < SPIRV_HEADER_WORDS ||
+      nwords > UINT32_MAX || spirv[0] != SPIRV_MAGIC_NUMBER || spirv[4] != 0u) {
+    return NGF_SPVZ_ERROR_INVALID_SPIRV;
+  }
+  _spvz_writer w = { out, out + *out_size };
+  if (!_write_raw(&w, NGF_SPVZ_MAGIC_NUMBER) || !_write_varint(&w, (uint32_t)nwords) ||
+      !_write_varint(&w, spirv[1]) || !_write_varint(&w, spirv[2]) ||
+      !_write_varint(&w, spirv[3])) {
+    return NGF_SPVZ_ERROR_BUFFER_TOO_SMALL;
+  }
+
+  uint32_t last_result = 0u;
+  for (size_t i = SPIRV_HEADER_WORDS; i < nwords;) {
+    const uint32_t op    = spirv[i] & 0xffffu;
+    const uint32_t len   = spirv[i] >> 16u;
+    const uint32_t info  = _opcode_info(op);
+    const uint32_t fixed = 1u + (info & HAS_TYPE ? 1u : 0u) + (info & HAS_RESULT ? 1u : 0u);
+    if (len < fixed || len > nwords - i) {
+      return NGF_SPVZ_ERROR_INVALID_SPIRV;
+    }
+    const uint32_t len_code = len - 1u < 15u ? len - 1u : 15u;
+    if (!_write_varint(&w, _swap_opcode(op) << 4u | len_code) ||
+        (len_code == 15u && !_write_varint(&w, len - 16u))) {
+      return NGF_SPVZ_ERROR_BUFFER_TOO_SMALL;
+    }
+    const uint32_t *operand = &spirv[i + 1u];
+    const uint32_t *end     = &spirv[i + len];
+    if (info & HAS_TYPE) {
+      if (!_write_varint(&w, *(operand++))) { return NGF_SPVZ_ERROR_BUFFER_TOO_SMALL; }
+    }
+    if (info & HAS_RESULT) {
+      const uint32_t result = *(operand++);
+      if (!_write_varint(&w, _zigzag(result - (last_result + 1u)))) {
+        return NGF_SPVZ_ERROR_BUFFER_TOO_SMALL;
+      }
+      last_result = result;
+    }
+    if (info & RAW) {
+      for (; operand < end; ++operand) {
+        if (!_write_raw(&w, *operand)) { return NGF_SPVZ_ERROR_BUFFER_TOO_SMALL; }
+      }
+    } else {
+      for (uint32_t n = info >> 8u; operand < end; ++operand, n -= (n > 0u ? 1u : 0u)) {
+        const uint32_t v = n > 0u ? _zigzag(last_result - *operand) : *operand;
+        if (!_write_varint(&w, v)) { return NGF_SPVZ_ERROR_BUFFER_TOO_SMALL; }
+      }
+    }
+    i += len;
+  }
+  *out_size = (size_t)(w.ptr - out);
+  return NGF_SPVZ_ERROR_OK;
+}
+
+// Reads the magic number and the number of words in the decoded module.
+static ngf_spvz_error _read_header(_spvz_reader *r, uint32_t *nwords) {
+  uint32_t magic;
+  if (!_read_raw(r, &magic)) {
+    return NGF_SPVZ_ERROR_MALFORMED_DATA;
+  }
+  if (magic != NGF_SPVZ_MAGIC_NUMBER) {
+    return NGF_SPVZ_ERROR_MAGIC_NUMBER_MISMATCH;
+  }
+  if (!_read_varint(r, nwords) || *nwords < SPIRV_HEADER_WORDS) {
+    return NGF_SPVZ_ERROR_MALFORMED_DATA;
+  }
+  return NGF_SPVZ_ERROR_OK;
+}
+
+ngf_spvz_error ngf_spvz_get_decoded_size(const uint8_t *data, size_t size, size_t *decoded_size) {
+  assert(data);
+  assert(decoded_size);
+  _spvz_reader r = { data, data + size };
+  uint32_t nwords = 0u;
+  const ngf_spvz_error err = _read_header(&r, &nwords);
+  if (err != NGF_SPVZ_ERROR_OK) {
+    return err;
+  }
+  *decoded_size = (size_t)nwords * sizeof(uint32_t);
+  return NGF_SPVZ_ERROR_OK;
+}
+
+ngf_spvz_error ngf_spvz_decode(const uint8_t *data, size_t size, uint32_t *out, size_t out_size) {
+  assert(data);
+  assert(out);
+  _spvz_reader r = { data, data + size };
+  uint32_t nwords = 0u;
+  const ngf_spvz_error err = _read_header(&r, &nwords);
+  if (err != NGF_SPVZ_ERROR_OK) {
+    return err;
+  }
+  if ((size_t)nwords * sizeof(uint32_t) > out_size) {
+    return NGF_SPVZ_ERROR_BUFFER_TOO_SMALL;
+  }
+  out[0] = SPIRV_MAGIC_NUMBER;
+  out[4] = 0u;
+  if (!_read_varint(&r, &out[1]) || !_read_varint(&r, &out[2]) || !_read_varint(&r, &out[3])) {
+    return NGF_SPVZ_ERROR_MALFORMED_DATA;
+  }
+
+  uint32_t last_result = 0u;
+  uint32_t *word = &out[SPIRV_HEADER_WORDS];
+  const uint32_t *out_end = &out[nwords];
+  while (r.ptr < r.end) {
+    uint32_t head, len;
+    if (!_read_varint(&r, &head)) {
+      return NGF_SPVZ_ERROR_MALFORMED_DATA;
+    }
+    const uint32_t op = _swap_opcode(head >> 4u);
+    len = (head & 0xfu) + 1u;
+    if (len == 16u) {
+      uint32_t extra_len;
+      if (!_read_varint(&r, &extra_len) || extra_len > 0xffffu - 16u) {
+        return NGF_SPVZ_ERROR_MALFORMED_DATA;
+      }
+      len += extra_len;
+    }
+    const uint32_t info  = _opcode_info(op);
+    const uint32_t fixed = 1u + (info & HAS_TYPE ? 1u : 0u) + (info & HAS_RESULT ? 1u : 0u);
+    if (op > 0xffffu || len < fixed || len > (size_t)(out_end - word)) {
+      return NGF_SPVZ_ERROR_MALFORMED_DATA;
+    }
+    const uint32_t *end = word + len;
+    *(word++) = len << 16u | op;
+    if (info & HAS_TYPE) {
+      if (!_read_varint(&r, word++)) { return NGF_SPVZ_ERROR_MALFORMED_DATA; }
+    }
+    if (info & HAS_RESULT) {
+      uint32_t delta;
+      if (!_read_varint(&r, &delta)) { return NGF_SPVZ_ERROR_MALFORMED_DATA; }
+      last_result = last_result + 1u + _unzigzag(delta);
+      *(word++) = last_result;
+    }
+    if (info & RAW) {
+      for (; word < end; ++word) {
+        if (!_read_raw(&r, word)) { return NGF_SPVZ_ERROR_MALFORMED_DATA; }
+      }
+    } else {
+      for (uint32_t n = info >> 8u; word < end; ++word, n -= (n > 0u ? 1u : 0u)) {
+        if (!_read_varint(&r, word)) { return NGF_SPVZ_ERROR_MALFORMED_DATA; }
+        if (n > 0u) { *word = last_result - _unzigzag(*word); }
+      }
+    }
+  }
+  return word == out_end ? NGF_SPVZ_ERROR_OK : NGF_SPVZ_ERROR_MALFORMED_DATA;
+}
+
+const char* ngf_spvz_get_error_name(const ngf_spvz_error err) {
+  static const char* ngf_spvz_error_names[] = {
+    "OK",
+    "INVALID_SPIRV",
+    "MAGIC_NUMBER_MISMATCH",
+    "MALFORMED_DATA",
+    "BUFFER_TOO_SMALL"
+  };
+  return ngf_spvz_error_names[err];
+}
@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2025 nicegraf contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * A lossless encoding for SPIR-V modules, in the spirit of SMOL-V. Opcodes and
+ * instruction lengths are packed into a single varint, result IDs are stored as
+ * deltas from the previous result ID, operands that refer to recent results are
+ * stored relative to the current one, and words implied by the SPIR-V header
+ * are dropped. Encoded modules are typically less than half the size of the
+ * originals, and compress better with general-purpose compressors than the
+ * originals do.
+ *
+ * The codec depends only on the C standard library, and performs no allocations:
+ * the caller provides all buffers.
+ */
+
+#define NGF_SPVZ_MAGIC_NUMBER (0x5a565053u) /**< "SPVZ" */
+
+typedef enum ngf_spvz_error {
+  NGF_SPVZ_ERROR_OK,
+  NGF_SPVZ_ERROR_INVALID_SPIRV,
+  NGF_SPVZ_ERROR_MAGIC_NUMBER_MISMATCH,
+  NGF_SPVZ_ERROR_MALFORMED_DATA,
+  NGF_SPVZ_ERROR_BUFFER_TOO_SMALL
+} ngf_spvz_error;
+
+/**
+ * @return An upper bound on the encoded size of a SPIR-V module of the given
+ * size in bytes.
+ */
+size_t ngf_spvz_encode_bound(size_t spirv_size);
+
+/**
+ * Encodes a SPIR-V module stored in host byte order.
+ * @param out Buffer to write the encoded module to.
+ * @param out_size On input, the capacity of `out`. On output, the number of
+ * bytes written.
+ */
+ngf_spvz_error ngf_spvz_encode(
+    const uint32_t* spirv,
+    size_t          spirv_size,
+    uint8_t*        out,
+    size_t*         out_size);
+
+/**
+ * Reads the size in bytes of the SPIR-V module that the given encoded data
+ * decodes to.
+ */
+ngf_spvz_error ngf_spvz_get_decoded_size(const uint8_t* data, size_t size, size_t* decoded_size);
+
+/**
+ * Decodes a module produced by `ngf_spvz_encode` into `out`, in host byte
+ * order. `out_size` must be at least the size reported by
+ * `ngf_spvz_get_decoded_size`. Malformed input is reported as an error and
+ * never causes reads or writes outside of the given buffers.
+ */
+ngf_spvz_error ngf_spvz_decode(
+    const uint8_t* data,
+    size_t         size,
+    uint32_t*      out,
+    size_t         out_size);
+
+const char* ngf_spvz_get_error_name(const ngf_spvz_error err);
+
+#if defined(__cplusplus)
+}
+#endif
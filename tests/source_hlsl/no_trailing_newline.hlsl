@@ -0,0 +1,13 @@
+// This file must not end with a newline: the technique declaration on the last line has to be
+// read in full even though nothing follows it.
+
+#include "inc/triangle.hlsl"
+
+float4 PSMain(Triangle_PSInput ps_in) : SV_TARGET {
+  return ps_in.position * 0.5 + 0.5;
+}
+
+Triangle_PSInput VSMain(uint vid : SV_VertexID) {
+  return Triangle(vid, 1.0);
+}
+//T: no_trailing_newline ps:PSMain vs:VSMain
\ No newline at end of file
@@ -1,5 +1,117 @@
 import os, sys, shutil, pathlib, logging, subprocess, filecmp, json, platform
 
+# Test cases that are also compiled with `-g no`.
+STRIPPED_CASES = {"spec_const_as_array_idx"}
+
+# Test cases whose compiled techniques are also serialized and loaded back.
+ROUNDTRIP_CASES = {"push_consts", "simple_texture", "spec_const_as_array_idx"}
+
+# Extra compilations of some test cases with additional command line options. Each variant names
+# the cases it applies to, the options it adds, and the extensions of the output files that are
+# compared against goldens, which are named <file>.<variant><extension>. Variants that set
+# "only_outputs" fail if they produce files with any other extension.
+VARIANTS = {
+  # Metadata in the legacy format must stay byte for byte the same as before the native format.
+  "legacy": {
+    "cases": {"custom_defines", "fullscreen_triangle", "fullscreen_triangle_crlf",
+              "precompute_dfg", "push_consts", "relative_luminance", "simple_texture",
+              "spec_const_as_array_idx", "texel_buffer", "texture_arrays", "unused_bindings"},
+    "params": ["-f", "0"],
+    "outputs": {".pipeline"}},
+  # Without cross-compilation, only the pipeline metadata and the header are written.
+  "reflection_only": {
+    "cases": {"precompute_dfg", "simple_texture"},
+    "params": ["-c", "no"],
+    "outputs": {".pipeline", ".h"},
+    "only_outputs": True},
+  # Shaders that take more code generation passes than the threshold are reported on stderr.
+  "pass_warnings": {
+    "cases": {"simple_texture"},
+    "params": ["-r", "1"],
+    "outputs": set()},
+  # Statistics for every generated shader are printed to stdout.
+  "stats": {
+    "cases": {"precompute_dfg"},
+    "params": ["-s", "yes"],
+    "outputs": set()},
+}
+
+def run_stripped_variant(compiler_binary, input_file, out_dir, LOG):
+  test_case_name = input_file.stem
+  stripped_dir = out_dir / 'stripped'
+  stripped_dir.mkdir(exist_ok = True)
+  run_params = [
+    str(compiler_binary),
+    str(input_file),
+    "-t", "spv",
+    "-t", "msl20",
+    "-t", "gl430",
+    "-O", str(stripped_dir),
+    "-h", str(input_file.name) + "_hdr.h",
+    "-p", "no",
+    "-g", "no",
+    "--",
+    "-O3",
+    "-Wno-ignored-attributes"]
+  LOG.debug(" ".join(run_params))
+  try:
+    run_result = subprocess.run(
+        run_params,
+        stdout = subprocess.PIPE,
+        stderr = subprocess.PIPE,
+        timeout = 60,
+        universal_newlines = True)
+  except subprocess.TimeoutExpired:
+    return "Timeout exceeded when stripping debug instructions"
+  if run_result.returncode != 0:
+    return "Process exited with nonzero exit code when stripping debug instructions"
+  (out_dir / (test_case_name + '.stripped.stdout')).write_bytes(bytes(run_result.stdout, 'utf-8'))
+  for stripped in stripped_dir.iterdir():
+    unstripped = out_dir / stripped.name
+    if stripped.suffix == '.spv':
+      if stripped.stat().st_size >= unstripped.stat().st_size:
+        return "Stripping did not make " + stripped.name + " smaller"
+      shutil.copyfile(str(stripped), str(out_dir / (stripped.stem + '.stripped.spv')))
+    elif not filecmp.cmp(str(stripped), str(unstripped), shallow = False):
+      return "Stripping debug instructions changed " + stripped.name
+  return None
+
+def run_variant(compiler_binary, input_file, case_params, out_dir, variant, LOG):
+  test_case_name = input_file.stem
+  variant_dir = out_dir / variant
+  variant_dir.mkdir(exist_ok = True)
+  run_params = [
+    str(compiler_binary),
+    str(input_file),
+    "-t", "spv",
+    "-t", "msl20",
+    "-t", "gl430",
+    "-O", str(variant_dir),
+    "-h", str(input_file.name) + "_hdr.h"] + case_params + VARIANTS[variant]["params"] + [
+    "--",
+    "-O3",
+    "-Wno-ignored-attributes"]
+  LOG.debug(" ".join(run_params))
+  try:
+    run_result = subprocess.run(
+        run_params,
+        stdout = subprocess.PIPE,
+        stderr = subprocess.PIPE,
+        timeout = 60,
+        universal_newlines = True)
+  except subprocess.TimeoutExpired:
+    return "Timeout exceeded in the " + variant + " variant"
+  if run_result.returncode != 0:
+    return "Process exited with nonzero exit code in the " + variant + " variant"
+  for stream, text in (('.stdout', run_result.stdout), ('.stderr', run_result.stderr)):
+    (out_dir / (test_case_name + '.' + variant + stream)).write_bytes(bytes(text, 'utf-8'))
+  for output in variant_dir.iterdir():
+    if output.suffix in VARIANTS[variant]["outputs"]:
+      shutil.copyfile(str(output), str(out_dir / (output.stem + '.' + variant + output.suffix)))
+    elif VARIANTS[variant].get("only_outputs", False):
+      return "Unexpected output " + output.name + " in the " + variant + " variant"
+  return None
+
 def main(argv):
   logging.basicConfig(format='%(asctime)-15s %(message)s')
   LOG = logging.getLogger(__name__)
@@ -27,6 +139,18 @@ def main(argv):
   if not jsonizer_binary.is_file():
     LOG.critical("missing display_metadata binary")
     sys.exit(1)
+  pack_jsonizer_binary = cwd / '..' / 'samples' / ('display_pack' + exe_ext)
+  if not pack_jsonizer_binary.is_file():
+    LOG.critical("missing display_pack binary")
+    sys.exit(1)
+  roundtrip_binary = cwd / '..' / 'samples' / ('roundtrip_techniques' + exe_ext)
+  if not roundtrip_binary.is_file():
+    LOG.critical("missing roundtrip_techniques binary")
+    sys.exit(1)
+  include_binary = cwd / '..' / 'samples' / ('resolve_includes' + exe_ext)
+  if not include_binary.is_file():
+    LOG.critical("missing resolve_includes binary")
+    sys.exit(1)
 
   LOG.info("Cleaning up old output")
   out_dir = cwd / 'output'
@@ -40,7 +164,11 @@ def main(argv):
     test_case_name = input_file.stem
     LOG.info("Running [%s]" % (test_case_name,))
     should_fail = test_case_name.endswith("_FAIL")
-    preserve_bindings = test_case_name == "unused_bindings"
+    preserve_bindings = test_case_name in ("unused_bindings", "library_mode")
+    pack_output = test_case_name == "shader_pack"
+    library_mode = test_case_name == "library_mode"
+    case_params = ["-p", "yes" if preserve_bindings else "no"] + \
+        (["-l", "yes", "-m", "6_3"] if library_mode else [])
     try:
       run_params = [
         str(compiler_binary),
@@ -49,8 +177,8 @@ def main(argv):
         "-t", "msl20", 
         "-t", "gl430", 
         "-O", str(out_dir), 
-        "-h", str(input_file.name) + "_hdr.h",
-        "-p", "yes" if preserve_bindings else "no",
+        "-h", str(input_file.name) + "_hdr.h"] + case_params + \
+        (["-a", test_case_name + ".shpk", "-z", "yes", "-g", "no"] if pack_output else []) + [
         "--", 
         "-O3",
         "-Wno-ignored-attributes"]
@@ -73,6 +201,37 @@ def main(argv):
     except subprocess.TimeoutExpired:
       failed_run_results[test_case_name] = "Timeout exceeded"
 
+    # Some cases are compiled a second time with debug instructions stripped from SPIR-V. Stripping
+    # must not affect the pipeline metadata, the header or the other targets, and the stripped
+    # SPIR-V is compared against its own goldens.
+    if test_case_name in STRIPPED_CASES and test_case_name not in failed_run_results:
+      error = run_stripped_variant(compiler_binary, input_file, out_dir, LOG)
+      if error is not None:
+        failed_run_results[test_case_name] = error
+
+    for variant, info in VARIANTS.items():
+      if test_case_name in info["cases"] and test_case_name not in failed_run_results:
+        error = run_variant(compiler_binary, input_file, case_params, out_dir, variant, LOG)
+        if error is not None:
+          failed_run_results[test_case_name] = error
+
+    # Serializing the compiled techniques and loading them back must not lose anything. The tool
+    # checks that itself, and prints what it loaded.
+    if test_case_name in ROUNDTRIP_CASES and test_case_name not in failed_run_results:
+      json_file = out_dir / (test_case_name + '.roundtrip.json')
+      try:
+        result = subprocess.run(
+          [str(roundtrip_binary), str(input_file), "spv", "msl20", "gl430"],
+          stdout = open(str(json_file), "w"), timeout = 60, universal_newlines = True)
+        if result.returncode != 0:
+          failed_run_results[test_case_name] = "Serialization round trip failed"
+        else:
+          json.loads(json_file.read_text())
+      except subprocess.TimeoutExpired:
+        failed_run_results[test_case_name] = "Timeout exceeded in serialization round trip"
+      except json.JSONDecodeError:
+        failed_run_results[test_case_name] = "Not valid JSON: " + str(json_file)
+
   if len(failed_run_results) > 0:
     LOG.critical("Some tests case runs failed")
     for test_case_name, error in failed_run_results.items():
@@ -90,6 +249,16 @@ def main(argv):
         LOG.critical("Failed to convert to JSON")
         sys.exit(1)
       validated_json = json.loads(json_file.read_text())
+      # Loading a copy of the file, and for the native format a byte-swapped copy, must produce
+      # the same metadata as reading the file in place.
+      load_modes = ["copy"] + (["swapped"] if not input_file.stem.endswith(".legacy") else [])
+      for load_mode in load_modes:
+        result = subprocess.run(
+          [str(jsonizer_binary), str(input_file), load_mode],
+          cwd = str(out_dir), stdout = subprocess.PIPE, universal_newlines=True)
+        if result.returncode != 0 or result.stdout != json_file.read_text():
+          LOG.critical("Loading " + input_file.name + " in " + load_mode + " mode differs")
+          sys.exit(1)
     except subprocess.TimeoutExpired:
       LOG.critical("Timeout expired when converting to JSON")
       sys.exit(1)
@@ -97,6 +266,39 @@ def main(argv):
       LOG.critical("Not valid JSON: " + str(json_file))
       sys.exit(1)
   
+  LOG.info("Converting shader packs to JSON")
+  for input_file in out_dir.glob("*.shpk"):
+    json_file = out_dir / (input_file.name + '.json')
+    try:
+      result = subprocess.run(
+        [str(pack_jsonizer_binary), str(input_file)],
+        cwd = str(out_dir), stdout = open(str(json_file), "w"), universal_newlines=True)
+      if result.returncode != 0:
+        LOG.critical("Failed to convert to JSON")
+        sys.exit(1)
+      validated_json = json.loads(json_file.read_text())
+    except subprocess.TimeoutExpired:
+      LOG.critical("Timeout expired when converting to JSON")
+      sys.exit(1)
+    except json.JSONDecodeError:
+      LOG.critical("Not valid JSON: " + str(json_file))
+      sys.exit(1)
+
+  # The include resolver and the include cache are only reachable through the library, so a sample
+  # exercises them and reports how each include was served.
+  LOG.info("Checking include handling")
+  try:
+    result = subprocess.run(
+      [str(include_binary), str(out_dir / 'resolve_includes')],
+      stdout = open(str(out_dir / 'resolve_includes.stdout'), "w"),
+      timeout = 60, universal_newlines = True)
+    if result.returncode != 0:
+      LOG.critical("Failed to check include handling")
+      sys.exit(1)
+  except subprocess.TimeoutExpired:
+    LOG.critical("Timeout expired when checking include handling")
+    sys.exit(1)
+
   LOG.info("Comparing output against goldens")
   filecmp.clear_cache()
   any_error = False